@@ -24,8 +24,23 @@ _nvc () {
   _safe ${NVC:-nvc} $_opts $*
 }
 
+# Libraries analysed by this script which have prebuilt JIT code
+# generated on successful exit
+_libs=()
+
+_jit_pack () {
+  local _status=$?
+  [ $_status = 0 ] || exit $_status
+  for _lib in $(printf "%s\n" "${_libs[@]}" | sort -u); do
+    STD=${_lib%%:*} WORK=${_lib#*:} _nvc --jit-pack
+  done
+}
+
+trap _jit_pack EXIT
+
 analyse () {
   local _files=$*
+  _libs+=("${STD:-1993}:${WORK:-work}")
   _nvc -a $A_OPTS $_files
 }
 
@@ -33,6 +48,7 @@ analyse_list () {
   local _work=$1
   shift
   if [ $# -gt 0 ]; then
+    _libs+=("${STD:-1993}:$_work")
     WORK=$_work _nvc -a $A_OPTS -f $*
   else
     while read _src; do
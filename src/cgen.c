@@ -39,9 +39,27 @@
 
 typedef A(ident_t) unit_list_t;
 
+typedef struct {
+   unit_list_t  units;
+   hset_t      *seen;
+} cgen_library_t;
+
+struct _cgen_stream {
+   unit_registry_t   *registry;
+   mir_context_t     *mir;
+   jit_t             *jit;
+   char              *fname;
+   FILE              *file;
+   jit_pack_stream_t *pack;
+   hset_t            *seen;
+   unit_list_t        linkage;
+   size_t             budget;
+   bool               flushing;
+};
+
 static void cgen_find_dependencies(mir_context_t *mc, unit_registry_t *ur,
-                                   unit_list_t *units, hset_t *seen,
-                                   ident_t name)
+                                   jit_t *jit, unit_list_t *units,
+                                   hset_t *seen, ident_t name)
 {
    mir_unit_t *mu = mir_get_unit(mc, name);
    if (mu == NULL) {
@@ -59,6 +77,8 @@ static void cgen_find_dependencies(mir_context_t *mc, unit_registry_t *ur,
          continue;
       else if (ident_char(link, 0) == '$')
          continue;   // TODO: handle VPI differently
+      else if (jit != NULL && jit_is_prebuilt(jit, link))
+         continue;   // Loaded from the library pack at runtime
       else {
          APUSH(*units, link);
          hset_insert(seen, link);
@@ -74,9 +94,15 @@ static void cgen_walk_hier(unit_list_t *units, hset_t *seen, tree_t block)
    assert(tree_kind(hier) == T_HIER);
 
    ident_t unit_name = tree_ident(hier), prefix = tree_ident2(hier);
-   APUSH(*units, unit_name);
-   assert(!hset_contains(seen, unit_name));
-   hset_insert(seen, unit_name);
+
+   // Blocks that share the unit of an earlier instance have no code
+   if (!(tree_flags(hier) & TREE_F_SHARED_UNIT)) {
+      if (hset_contains(seen, unit_name))
+         return;   // Subtree already added by cgen_stream_block
+
+      APUSH(*units, unit_name);
+      hset_insert(seen, unit_name);
+   }
 
    const int nstmts = tree_stmts(block);
    for (int i = 0; i < nstmts; i++) {
@@ -102,20 +128,224 @@ static void cgen_walk_hier(unit_list_t *units, hset_t *seen, tree_t block)
    }
 }
 
-static void cgen_jit_pack(ident_t name, jit_t *jit, unit_list_t *units)
+static FILE *cgen_open_pack(const char *fname)
 {
-   const char *fname LOCAL = xasprintf("_%s.pack", istr(name));
-
    FILE *f = lib_fopen(lib_work(), fname, "wb");
    if (f == NULL)
       fatal_errno("fopen: %s", fname);
 
+   return f;
+}
+
+static void cgen_jit_pack(ident_t name, jit_t *jit, unit_list_t *units)
+{
+   const char *fname LOCAL = xasprintf("_%s.pack", istr(name));
+
+   FILE *f = cgen_open_pack(fname);
    jit_write_pack(jit, units->items, units->count, f);
    fclose(f);
 
    progress("writing JIT pack");
 }
 
+cgen_stream_t *cgen_stream_new(ident_t name, unit_registry_t *ur,
+                               mir_context_t *mc, jit_t *jit, size_t budget)
+{
+   cgen_stream_t *cs = xcalloc(sizeof(cgen_stream_t));
+   cs->registry = ur;
+   cs->mir      = mc;
+   cs->jit      = jit;
+   cs->budget   = budget;
+   cs->seen     = hset_new(128);
+   cs->fname    = xasprintf("_%s.pack", istr(name));
+   cs->file     = cgen_open_pack(cs->fname);
+   cs->pack     = jit_pack_stream_new(jit, cs->file);
+
+   return cs;
+}
+
+void cgen_stream_block(cgen_stream_t *cs, tree_t block)
+{
+   // Once the process has reached the memory budget compile each
+   // instance as soon as its subtree is elaborated and release the MIR
+   // for its units
+   if (!cs->flushing && nvc_peak_rss() < cs->budget)
+      return;
+
+   cs->flushing = true;
+
+   unit_list_t units = AINIT;
+   cgen_walk_hier(&units, cs->seen, block);
+
+   for (int i = 0; i < units.count; i++) {
+      jit_pack_stream_put(cs->pack, units.items[i]);
+
+      mir_unit_t *mu = mir_get_unit(cs->mir, units.items[i]);
+      if (mu == NULL)
+         continue;
+
+      // Dependencies such as subprograms in an enclosing block may not
+      // be complete yet so they are added by cgen_stream_finish
+      const int nlink = mir_count_linkage(mu);
+      for (int j = 0; j < nlink; j++)
+         APUSH(cs->linkage, mir_get_linkage(mu, j));
+
+      mir_unit_free(mu);
+   }
+
+   ACLEAR(units);
+}
+
+void cgen_stream_finish(cgen_stream_t *cs, tree_t top)
+{
+   assert(tree_kind(top) == T_ELAB);
+
+   unit_list_t units = AINIT;
+   cgen_walk_hier(&units, cs->seen, tree_stmt(top, 0));
+
+   for (int i = 0; i < cs->linkage.count; i++) {
+      ident_t link = cs->linkage.items[i];
+      if (hset_contains(cs->seen, link))
+         continue;
+      else if (ident_char(link, 0) == '$')
+         continue;   // TODO: handle VPI differently
+      else if (jit_is_prebuilt(cs->jit, link))
+         continue;
+
+      APUSH(units, link);
+      hset_insert(cs->seen, link);
+   }
+
+   for (int i = 0; i < units.count; i++)
+      cgen_find_dependencies(cs->mir, cs->registry, cs->jit, &units,
+                             cs->seen, units.items[i]);
+
+   for (int i = 0; i < units.count; i++)
+      jit_pack_stream_put(cs->pack, units.items[i]);
+
+   ACLEAR(units);
+
+   jit_pack_stream_close(cs->pack);
+   fclose(cs->file);
+   cs->pack = NULL;
+
+   progress("writing JIT pack");
+
+   cgen_stream_free(cs);
+}
+
+void cgen_stream_free(cgen_stream_t *cs)
+{
+   if (cs->pack != NULL) {
+      // Elaboration failed so remove the incomplete pack
+      jit_pack_stream_discard(cs->pack);
+      fclose(cs->file);
+      lib_delete(lib_work(), cs->fname);
+   }
+
+   free(cs->fname);
+   hset_free(cs->seen);
+   ACLEAR(cs->linkage);
+   free(cs);
+}
+
+static void cgen_library_decls(unit_list_t *units, hset_t *seen, tree_t unit)
+{
+   const int ndecls = tree_decls(unit);
+   for (int i = 0; i < ndecls; i++) {
+      tree_t d = tree_decl(unit, i);
+      switch (tree_kind(d)) {
+      case T_FUNC_BODY:
+      case T_PROC_BODY:
+      case T_FUNC_INST:
+      case T_PROC_INST:
+         if (!is_uninstantiated_subprogram(d)) {
+            ident_t name = tree_ident2(d);
+            if (!hset_contains(seen, name)) {
+               APUSH(*units, name);
+               hset_insert(seen, name);
+            }
+         }
+         break;
+      default:
+         break;
+      }
+   }
+}
+
+static void cgen_library_cb(lib_t lib, ident_t name, int kind, void *ctx)
+{
+   cgen_library_t *cl = ctx;
+
+   if (kind != T_PACKAGE && kind != T_PACK_INST)
+      return;
+
+   tree_t unit = lib_get(lib, name);
+   if (unit == NULL || is_uninstantiated_package(unit))
+      return;
+
+   tree_t body = NULL;
+   if (kind == T_PACKAGE && package_needs_body(unit)
+       && (body = body_of(unit)) == NULL)
+      return;
+
+   APUSH(cl->units, name);
+   hset_insert(cl->seen, name);
+
+   cgen_library_decls(&cl->units, cl->seen, unit);
+
+   if (body != NULL)
+      cgen_library_decls(&cl->units, cl->seen, body);
+}
+
+void cgen_library(lib_t lib, unit_registry_t *ur, mir_context_t *mc,
+                  jit_t *jit)
+{
+   cgen_library_t cl = {
+      .units = AINIT,
+      .seen  = hset_new(256),
+   };
+
+   lib_walk_index(lib, cgen_library_cb, &cl);
+
+   for (int i = 0; i < cl.units.count; i++)
+      cgen_find_dependencies(mc, ur, jit, &cl.units, cl.seen,
+                             cl.units.items[i]);
+
+   hset_free(cl.seen);
+
+   // Code from other libraries is never included as it would go stale
+   // when those libraries are reanalysed: it is either loaded from their
+   // own pack or compiled into the design
+   ident_t lname = lib_name(lib);
+   int nunits = 0;
+   for (int i = 0; i < cl.units.count; i++) {
+      if (ident_until(cl.units.items[i], '.') == lname)
+         cl.units.items[nunits++] = cl.units.items[i];
+   }
+   ATRIM(cl.units, nunits);
+
+   // Write to a temporary file first as other processes may be
+   // reading the existing pack
+   const char *tmp LOCAL = xasprintf("%s.%d.tmp", LIB_JIT_PACK, getpid());
+
+   FILE *f = lib_fopen(lib, tmp, "wb");
+   if (f == NULL)
+      fatal_errno("fopen: %s", tmp);
+
+   jit_write_pack(jit, cl.units.items, cl.units.count, f);
+   fclose(f);
+
+   char from[PATH_MAX], to[PATH_MAX];
+   lib_realpath(lib, tmp, from, sizeof(from));
+   lib_realpath(lib, LIB_JIT_PACK, to, sizeof(to));
+   replace_file(from, to);
+
+   ACLEAR(cl.units);
+
+   progress("writing JIT pack for library %s", istr(lib_name(lib)));
+}
+
 void cgen(tree_t top, unit_registry_t *ur, mir_context_t *mc, jit_t *jit)
 {
    assert(tree_kind(top) == T_ELAB);
@@ -126,7 +356,7 @@ void cgen(tree_t top, unit_registry_t *ur, mir_context_t *mc, jit_t *jit)
    cgen_walk_hier(&units, seen, tree_stmt(top, 0));
 
    for (int i = 0; i < units.count; i++)
-      cgen_find_dependencies(mc, ur, &units, seen, units.items[i]);
+      cgen_find_dependencies(mc, ur, jit, &units, seen, units.items[i]);
 
    hset_free(seen);
    seen = NULL;
@@ -294,6 +294,10 @@ typedef enum {
    W_VERILOG_WIRE_ARRAY,
    W_DLR_SIGNED,
    W_DLR_CLOG2,
+   W_DLR_DISPLAY,
+   W_DLR_WRITE,
+   W_DLR_MONITOR,
+   W_DLR_STROBE,
    W_COUNTERS,
 
    NUM_WELL_KNOWN
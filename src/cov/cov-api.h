@@ -180,6 +180,13 @@ typedef enum {
    COV_FLAG_UNREACHABLE    = (1 << 31),
 } cover_flags_t;
 
+// Statement and branch counters which always execute together with
+// another counter in the same basic block are not incremented at run
+// time but instead hold a reference to the other counter's tag
+#define COV_COUNTER_ALIAS(tag)  (INT32_MIN | (int32_t)(tag))
+#define COV_COUNTER_IS_ALIAS(c) ((c) < 0)
+#define COV_COUNTER_TAG(c)      ((c) & INT32_MAX)
+
 #define COVER_FLAGS_AND_EXPR (COV_FLAG_11 | COV_FLAG_10 | COV_FLAG_01)
 #define COVER_FLAGS_OR_EXPR (COV_FLAG_00 | COV_FLAG_10 | COV_FLAG_01)
 #define COVER_FLAGS_XOR_EXPR (COV_FLAG_11 | COV_FLAG_00 | COV_FLAG_10 | COV_FLAG_01)
@@ -208,6 +215,7 @@ typedef enum {
    COVER_MASK_TOGGLE_INCLUDE_MEMS         = (1 << 10),
    COVER_MASK_EXCLUDE_UNREACHABLE         = (1 << 11),
    COVER_MASK_FSM_NO_DEFAULT_ENUMS        = (1 << 12),
+   COVER_MASK_STOP_AT_THRESHOLD           = (1 << 13),
    COVER_MASK_DONT_PRINT_COVERED          = (1 << 16),
    COVER_MASK_DONT_PRINT_UNCOVERED        = (1 << 17),
    COVER_MASK_DONT_PRINT_EXCLUDED         = (1 << 18),
@@ -233,6 +241,8 @@ void cover_merge(cover_data_t *dst, const cover_data_t *src, merge_mode_t mode);
 
 int32_t *cover_get_counters(cover_data_t *db, ident_t name);
 cover_scope_t *cover_get_scope(cover_data_t *db, ident_t name);
+const cover_item_t *cover_get_item(cover_data_t *db, ident_t name,
+                                   int32_t tag);
 
 //
 // Spec and exclude file handling
@@ -762,13 +762,33 @@ void cover_merge_one_item(cover_item_t *item, int32_t data)
    }
 }
 
+static int32_t cover_get_count(const cover_block_t *b, const cover_item_t *item)
+{
+   const int32_t count = b->data[item->tag];
+
+   switch (item->kind) {
+   case COV_ITEM_STMT:
+   case COV_ITEM_BRANCH:
+      // Counter was merged with the first counter in the same basic
+      // block during code generation
+      if (COV_COUNTER_IS_ALIAS(count)) {
+         const int32_t target = b->data[COV_COUNTER_TAG(count)];
+         assert(!COV_COUNTER_IS_ALIAS(target));
+         return target;
+      }
+      return count;
+   default:
+      return count;
+   }
+}
+
 static void cover_update_counts(cover_scope_t *s)
 {
    if (s->block != NULL && s->block->data != NULL) {
       for (int i = 0; i < s->items.count; i++) {
          cover_item_t *item = s->items.items[i];
          for (int j = 0; j < item->consecutive; j++)
-            cover_merge_one_item(item + j, s->block->data[item[j].tag]);
+            cover_merge_one_item(item + j, cover_get_count(s->block, item + j));
       }
    }
 
@@ -1387,6 +1407,44 @@ cover_scope_t *cover_get_scope(cover_data_t *db, ident_t name)
    return b->self;
 }
 
+static void cover_index_items(cover_scope_t *s, cover_block_t *b)
+{
+   if (s->block != b)
+      return;
+
+   for (int i = 0; i < s->items.count; i++) {
+      cover_item_t *item = s->items.items[i];
+      for (int j = 0; j < item->consecutive; j++) {
+         assert(item->tag + j < b->tag_map_size);
+         b->tag_map[item->tag + j] = item + j;
+      }
+   }
+
+   for (int i = 0; i < s->children.count; i++)
+      cover_index_items(s->children.items[i], b);
+}
+
+const cover_item_t *cover_get_item(cover_data_t *db, ident_t name,
+                                   int32_t tag)
+{
+   if (db == NULL)
+      return NULL;
+
+   cover_block_t *b = hash_get(db->blocks, name);
+   if (b == NULL || b->self == NULL || tag < 0 || tag >= b->next_tag)
+      return NULL;
+
+   // Build a table mapping tags to items on the first lookup so each
+   // signal does not have to search the whole block
+   if (b->tag_map_size != b->next_tag) {
+      b->tag_map = pool_calloc(db->pool, b->next_tag * sizeof(cover_item_t *));
+      b->tag_map_size = b->next_tag;
+      cover_index_items(b->self, b);
+   }
+
+   return b->tag_map[tag];
+}
+
 void cover_bmask_to_bin_list(uint32_t bmask, text_buf_t *tb)
 {
    bool empty = true;
@@ -19,9 +19,11 @@
 #include "array.h"
 #include "cov/cov-api.h"
 #include "cov/cov-data.h"
+#include "hash.h"
 #include "ident.h"
 
 #include <limits.h>
+#include <stdlib.h>
 #include <string.h>
 
 struct _cover_exclude_ctx {
@@ -30,6 +32,26 @@ struct _cover_exclude_ctx {
    loc_t    loc;
 };
 
+typedef struct _excl_node excl_node_t;
+
+// Prefix tree of the literal text before the first wildcard in each
+// exclude pattern
+struct _excl_node {
+   excl_node_t *child;
+   excl_node_t *sibling;
+   int          first;
+   char         ch;
+};
+
+typedef struct {
+   cover_ef_t  *ef;
+   hash_t      *exact;
+   int         *next;
+   excl_node_t  root;
+   A(int)       cands;
+   A(int)       matches;
+} excl_index_t;
+
 static void to_upper_str(char *str)
 {
    while (*str) {
@@ -42,40 +64,183 @@ static void to_upper_str(char *str)
 // Exclude file
 ///////////////////////////////////////////////////////////////////////////////
 
-static void cover_exclude_items(cover_ef_t *ef, cover_item_t *item)
+static excl_node_t *excl_node_child(const excl_node_t *n, char ch)
+{
+   excl_node_t *it = n->child;
+   for (; it != NULL && it->ch != ch; it = it->sibling);
+   return it;
+}
+
+static void excl_node_free(excl_node_t *n)
+{
+   for (excl_node_t *it = n->child, *next; it != NULL; it = next) {
+      next = it->sibling;
+      excl_node_free(it);
+      free(it);
+   }
+}
+
+static void excl_index_init(excl_index_t *idx, cover_ef_t *ef)
+{
+   idx->ef    = ef;
+   idx->exact = hash_new(ef->n_excl_cmds * 2);
+   idx->next  = xmalloc_array(ef->n_excl_cmds, sizeof(int));
+
+   idx->root.first = -1;
+
+   // Insert in reverse so each chain of commands is in file order
+   for (int i = ef->n_excl_cmds - 1; i >= 0; i--) {
+      ident_t hier = ef->excl[i].hier;
+      const char *str = istr(hier), *star = strchr(str, '*');
+
+      if (star == NULL) {
+         // Without a wildcard the pattern can only match itself
+         void *head = hash_get(idx->exact, hier);
+         idx->next[i] = head ? (intptr_t)head - 1 : -1;
+         hash_put(idx->exact, hier, (void *)(intptr_t)(i + 1));
+         continue;
+      }
+
+      excl_node_t *n = &(idx->root);
+      for (const char *p = str; p < star; p++) {
+         excl_node_t *c = excl_node_child(n, *p);
+         if (c == NULL) {
+            c = xcalloc(sizeof(excl_node_t));
+            c->ch      = *p;
+            c->first   = -1;
+            c->sibling = n->child;
+            n->child   = c;
+         }
+         n = c;
+      }
+
+      idx->next[i] = n->first;
+      n->first = i;
+   }
+}
+
+static void excl_index_free(excl_index_t *idx)
+{
+   excl_node_free(&(idx->root));
+   hash_free(idx->exact);
+   free(idx->next);
+   ACLEAR(idx->cands);
+   ACLEAR(idx->matches);
+}
+
+static void excl_index_push(excl_index_t *idx, const excl_node_t *n)
+{
+   for (int i = n->first; i != -1; i = idx->next[i])
+      APUSH(idx->cands, i);
+}
+
+static const excl_node_t *excl_index_walk(excl_index_t *idx,
+                                          const excl_node_t *n,
+                                          ident_t hier, size_t pos)
+{
+   // Add every pattern whose literal prefix ends between the given
+   // position and the end of the name to the candidate list
+   const char *str = istr(hier);
+   const size_t len = ident_len(hier);
+
+   for (; n != NULL && pos < len; pos++) {
+      if ((n = excl_node_child(n, str[pos])) != NULL)
+         excl_index_push(idx, n);
+   }
+
+   return n;
+}
+
+static int excl_index_cmp(const void *a, const void *b)
+{
+   return *(const int *)a - *(const int *)b;
+}
+
+static void cover_exclude_items(excl_index_t *idx, cover_item_t *item,
+                                ident_t prefix, const excl_node_t *n,
+                                int base)
 {
    for (int i = 0; i < item->consecutive; i++) {
       ident_t hier = item[i].hier;
 
-      for (int j = 0; j < ef->n_excl_cmds; j++) {
-         cover_excl_cmd_t *excl = &(ef->excl[j]);
-         const char *excl_hier = istr(excl->hier);
+      ATRIM(idx->matches, 0);
 
-         if (ident_glob(hier, excl_hier, strlen(excl_hier))) {
-            excl->found = true;
+      void *head = hash_get(idx->exact, hier);
+      for (int j = head ? (intptr_t)head - 1 : -1; j != -1; j = idx->next[j])
+         APUSH(idx->matches, j);
 
-            const char *kind_str = cover_item_kind_str(item[i].kind);
-            if (item[i].data >= item[i].atleast) {
-               warn_at(&excl->loc, "%s: '%s' is already covered, "
-                                   "it will be reported as covered.",
-                                   kind_str, istr(hier));
-            }
-            else {
-               note_at(&excl->loc, "excluding %s: '%s'", kind_str, istr(hier));
-               item[i].flags |= COV_FLAG_EXCLUDED;
-            }
+      const int top = idx->cands.count;
+      int first = base;
+
+      // Continue from the position of the enclosing scope in the prefix
+      // tree unless the item name does not start with the scope name
+      if (prefix != NULL && ident_starts_with(hier, prefix))
+         excl_index_walk(idx, n, hier, ident_len(prefix));
+      else {
+         first = top;
+         excl_index_push(idx, &(idx->root));
+         excl_index_walk(idx, &(idx->root), hier, 0);
+      }
+
+      for (int j = first; j < idx->cands.count; j++) {
+         const int nth = idx->cands.items[j];
+         const char *excl_hier = istr(idx->ef->excl[nth].hier);
+         if (ident_glob(hier, excl_hier, strlen(excl_hier)))
+            APUSH(idx->matches, nth);
+      }
+
+      ATRIM(idx->cands, top);
+
+      // Apply in the same order as the commands in the file
+      qsort(idx->matches.items, idx->matches.count, sizeof(int),
+            excl_index_cmp);
+
+      for (int j = 0; j < idx->matches.count; j++) {
+         cover_excl_cmd_t *excl = &(idx->ef->excl[idx->matches.items[j]]);
+         excl->found = true;
+
+         const char *kind_str = cover_item_kind_str(item[i].kind);
+         if (item[i].data >= item[i].atleast) {
+            warn_at(&excl->loc, "%s: '%s' is already covered, "
+                                "it will be reported as covered.",
+                                kind_str, istr(hier));
+         }
+         else {
+            note_at(&excl->loc, "excluding %s: '%s'", kind_str, istr(hier));
+            item[i].flags |= COV_FLAG_EXCLUDED;
          }
       }
    }
 }
 
-static void cover_exclude_scope(cover_data_t *data, cover_scope_t *s)
+static void cover_exclude_scope(excl_index_t *idx, cover_scope_t *s,
+                                ident_t prefix, const excl_node_t *n,
+                                int base)
 {
+   const int top = idx->cands.count;
+
+   // Advance through the prefix tree by the part of the scope name
+   // not already matched by the parent scope
+   if (s->hier == NULL)
+      ;
+   else if (prefix != NULL && ident_starts_with(s->hier, prefix)) {
+      n = excl_index_walk(idx, n, s->hier, ident_len(prefix));
+      prefix = s->hier;
+   }
+   else {
+      base = top;
+      excl_index_push(idx, &(idx->root));
+      n = excl_index_walk(idx, &(idx->root), s->hier, 0);
+      prefix = s->hier;
+   }
+
    for (int i = 0; i < s->items.count; i++)
-      cover_exclude_items(data->ef, AGET(s->items, i));
+      cover_exclude_items(idx, AGET(s->items, i), prefix, n, base);
 
    for (int i = 0; i < s->children.count; i++)
-      cover_exclude_scope(data, s->children.items[i]);
+      cover_exclude_scope(idx, s->children.items[i], prefix, n, base);
+
+   ATRIM(idx->cands, top);
 }
 
 static void cover_parse_exclude_file(const char *path, cover_data_t *data)
@@ -183,7 +348,15 @@ static void cover_apply_exclude_cmds(cover_data_t *data)
    for (int i = 0; i < data->ef->n_excl_cmds; i++)
       data->ef->excl[i].found = false;
 
-   cover_exclude_scope(data, data->root_scope);
+   if (data->ef->n_excl_cmds == 0)
+      return;
+
+   excl_index_t idx = {};
+   excl_index_init(&idx, data->ef);
+
+   cover_exclude_scope(&idx, data->root_scope, NULL, NULL, 0);
+
+   excl_index_free(&idx);
 
    for (int i = 0; i < data->ef->n_excl_cmds; i++)
       if (!data->ef->excl[i].found)
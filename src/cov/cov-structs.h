@@ -31,6 +31,8 @@ typedef struct _cover_block {
    cover_scope_t *self;
    hash_t        *item_map;
    int32_t       *data;
+   cover_item_t **tag_map;
+   unsigned       tag_map_size;
 } cover_block_t;
 
 typedef struct {
@@ -37,6 +37,7 @@
 #include "vhdl/vhdl-phase.h"
 #include "vlog/vlog-defs.h"
 #include "vlog/vlog-node.h"
+#include "vlog/vlog-number.h"
 #include "vlog/vlog-phase.h"
 #include "vlog/vlog-util.h"
 
@@ -59,6 +60,8 @@ typedef struct _elab_ctx {
    tree_t            inst;
    ident_t           dotted;
    ident_t           cloned;
+   bool              shared;
+   bool             *shareable;
    lib_t             library;
    jit_t            *jit;
    unit_registry_t  *registry;
@@ -68,9 +71,11 @@ typedef struct _elab_ctx {
    sdf_file_t       *sdf;
    hash_t           *modcache;
    hash_t           *mracache;
+   hset_t           *depcache;
    rt_model_t       *model;
    rt_scope_t       *scope;
    mem_pool_t       *pool;
+   cgen_stream_t    *stream;
    unsigned          depth;
    unsigned          errors;
 } elab_ctx_t;
@@ -97,12 +102,15 @@ typedef struct {
    ghash_t  *instances;
    unsigned  count;
    unsigned  unique;
+   unsigned  shared;
 } mod_cache_t;
 
 typedef struct {
    vlog_node_t body;
    tree_t      block;
    tree_t      wrap;
+   tree_t      inst;
+   bool        shareable;
 } elab_instance_t;
 
 static void elab_block(tree_t t, const elab_ctx_t *ctx);
@@ -1530,10 +1538,12 @@ static void elab_inherit_context(elab_ctx_t *ctx, const elab_ctx_t *parent)
    ctx->inst     = ctx->inst ?: parent->inst;
    ctx->modcache = parent->modcache;
    ctx->mracache = parent->mracache;
+   ctx->depcache = parent->depcache;
    ctx->depth    = parent->depth + 1;
    ctx->model    = parent->model;
    ctx->errors   = error_count();
    ctx->pool     = parent->pool;
+   ctx->stream   = parent->stream;
 }
 
 static bool elab_new_errors(const elab_ctx_t *ctx)
@@ -1546,17 +1556,22 @@ static void elab_lower(tree_t b, elab_ctx_t *ctx)
    tree_t hier = tree_decl(b, 0);
    assert(tree_kind(hier) == T_HIER);
 
-   if (tree_subkind(hier) == T_VERILOG)
+   if (ctx->parent->shared && !ctx->shared)
+      fatal_trace("cannot lower %s inside shared instance", istr(ctx->dotted));
+
+   if (ctx->shared)
+      ;   // Uses the instance unit of the block named by cloned
+   else if (tree_subkind(hier) == T_VERILOG)
       vlog_lower_block(ctx->mir, ctx->parent->dotted, b);
    else
       ctx->lowered = lower_instance(ctx->registry, ctx->parent->lowered,
                                     ctx->cover, b);
 
 #ifdef DEBUG
-   if (ctx->cloned != NULL) {
+   if (ctx->cloned != NULL && !ctx->shared) {
       // Cloned blocks must have identical layout
       mir_unit_t *new = mir_get_unit(ctx->mir, ctx->dotted);
-      mir_unit_t *orig = mir_get_unit(ctx->mir, ctx->cloned);
+      mir_shape_t *orig = mir_get_shape(ctx->mir, ctx->cloned);
       mir_compare_layout(new, orig);
    }
 #endif
@@ -1775,10 +1790,9 @@ static void elab_verilog_instance_list(vlog_node_t v, const elab_ctx_t *ctx)
    }
 }
 
-static void elab_verilog_block(vlog_node_t v, const elab_ctx_t *ctx)
+static void elab_verilog_block(vlog_node_t v, ident_t id, tree_t param,
+                               ident_t cloned, const elab_ctx_t *ctx)
 {
-   ident_t id = vlog_ident(v);
-
    tree_t b = tree_new(T_BLOCK);
    tree_set_ident(b, id);
    tree_set_loc(b, vlog_loc(v));
@@ -1790,6 +1804,7 @@ static void elab_verilog_block(vlog_node_t v, const elab_ctx_t *ctx)
    elab_ctx_t new_ctx = {
       .out    = b,
       .dotted = ndotted,
+      .cloned = cloned,
    };
    elab_inherit_context(&new_ctx, ctx);
 
@@ -1802,6 +1817,9 @@ static void elab_verilog_block(vlog_node_t v, const elab_ctx_t *ctx)
 
    vlog_trans(v, b);
 
+   if (param != NULL)
+      tree_add_decl(b, param);
+
    elab_lower(b, &new_ctx);
    elab_verilog_stmts(v, &new_ctx);
 
@@ -1850,15 +1868,40 @@ static void elab_verilog_for_generate(vlog_node_t v, const elab_ctx_t *ctx)
    vlog_node_t s0 = vlog_stmt(v, 0);
    assert(vlog_kind(s0) == V_BLOCK);
 
+   // If the genvar is only used where its value can be read at run
+   // time then every iteration is a clone of the first with the genvar
+   // as an instance parameter
+   vlog_node_t shared = vlog_generate_block(s0, genvar);
+   ident_t first = NULL;
+
    while (jit_call_thunk2(ctx->jit, test, context,
                           elab_verilog_for_generate_test_cb, NULL)) {
       int32_t index;
       jit_call_thunk2(ctx->jit, get_var, context,
                       elab_verilog_for_generate_index_cb, &index);
 
-      vlog_node_t copy = vlog_generate_instance(s0, genvar, index, ctx->dotted);
+      if (shared != NULL) {
+         ident_t id = ident_sprintf("%s[%d]", istr(vlog_ident(s0)), index);
+
+         vlog_node_t num = vlog_new(V_NUMBER);
+         vlog_set_number(num, number_from_int(index));
+         vlog_set_loc(num, vlog_loc(genvar));
+
+         tree_t param = tree_new(T_VERILOG);
+         tree_set_ident(param, vlog_ident(genvar));
+         tree_set_loc(param, vlog_loc(genvar));
+         tree_set_vlog(param, num);
 
-      elab_verilog_block(copy, ctx);
+         elab_verilog_block(shared, id, param, first, ctx);
+
+         if (first == NULL)
+            first = ident_prefix(ctx->dotted, id, '.');
+      }
+      else {
+         vlog_node_t copy =
+            vlog_generate_instance(s0, genvar, index, ctx->dotted);
+         elab_verilog_block(copy, vlog_ident(copy), NULL, NULL, ctx);
+      }
 
       jit_call_thunk2(ctx->jit, step, context, NULL, NULL);
    }
@@ -1896,7 +1939,9 @@ static void elab_verilog_stmts(vlog_node_t v, const elab_ctx_t *ctx)
 
             tree_add_stmt(ctx->out, w);
 
-            if (kind == V_UDP_TABLE)
+            if (ctx->cloned != NULL)
+               break;   // Uses the process unit of the first clone
+            else if (kind == V_UDP_TABLE)
                mir_defer(ctx->mir, sym, ctx->dotted, MIR_UNIT_PROCESS,
                          vlog_lower_udp, vlog_to_object(v));
             else
@@ -1905,7 +1950,7 @@ static void elab_verilog_stmts(vlog_node_t v, const elab_ctx_t *ctx)
          }
          break;
       case V_BLOCK:
-         elab_verilog_block(s, ctx);
+         elab_verilog_block(s, vlog_ident(s), NULL, NULL, ctx);
          break;
       case V_IF_GENERATE:
          error_at(vlog_loc(s), "if-generate construct could not be "
@@ -2111,6 +2156,66 @@ static void elab_bind_components(tree_t block, tree_t config)
    }
 }
 
+static bool elab_can_share(tree_t unit, const elab_ctx_t *ctx)
+{
+   // The instance unit embeds the coverage scope and any path names so
+   // cannot be reused by other instances in that case
+   if (ctx->cover != NULL || generic_override != NULL)
+      return false;
+
+   tree_global_flags_t gflags = tree_global_flags(unit);
+   if (is_design_unit(unit))
+      gflags |= tree_global_flags(primary_unit_of(unit));
+
+   const tree_global_flags_t mask =
+      TREE_GF_INSTANCE_NAME | TREE_GF_PATH_NAME | TREE_GF_EXTERNAL_NAME;
+   return !(gflags & mask);
+}
+
+static void elab_clone_instance(const elab_instance_t *ei, tree_t inst,
+                                mod_cache_t *mc, elab_ctx_t *ctx)
+{
+   ctx->cloned = tree_ident(ei->block);
+
+   // An instance created by the same statement as the first has
+   // identical code so can skip lowering and reuse its unit
+   if (ei->shareable && ei->inst == inst) {
+      ctx->shared = true;
+      mc->shared++;
+   }
+}
+
+static void elab_external_names_cb(tree_t unit, void *context)
+{
+   const elab_ctx_t *ctx = context;
+
+   if (tree_global_flags(ctx->out) & TREE_GF_EXTERNAL_NAME)
+      return;
+   else if (hset_contains(ctx->depcache, unit))
+      return;
+
+   hset_insert(ctx->depcache, unit);
+
+   if (tree_global_flags(unit) & TREE_GF_EXTERNAL_NAME)
+      tree_set_global_flags(ctx->out, TREE_GF_EXTERNAL_NAME);
+   else {
+      if (tree_kind(unit) == T_PACKAGE) {
+         tree_t body = body_of(unit);
+         if (body != NULL)
+            elab_external_names_cb(body, context);
+      }
+
+      tree_walk_deps(unit, elab_external_names_cb, context);
+   }
+}
+
+static void elab_external_names(tree_t unit, const elab_ctx_t *ctx)
+{
+   // The runtime keeps the last value of every signal if an external
+   // name appears anywhere in the design or the packages it uses
+   elab_external_names_cb(unit, (void *)ctx);
+}
+
 static void elab_architecture(tree_t inst, tree_t arch, const elab_ctx_t *ctx)
 {
    ident_t label = tree_ident(inst);
@@ -2134,21 +2239,27 @@ static void elab_architecture(tree_t inst, tree_t arch, const elab_ctx_t *ctx)
    mod_cache_t *mc = elab_cached_module(tree_to_object(arch), &new_ctx);
    mc->count++;
 
+   bool shareable = false;
    elab_instance_t *ei = ghash_get(mc->instances, inst);
    if (ei == NULL) {
       ei = pool_calloc(ctx->pool, sizeof(elab_instance_t));
       ei->block = vhdl_architecture_instance(arch, inst, new_ctx.dotted);
+      ei->inst  = inst;
 
       elab_fold_generics(ei->block, &new_ctx);
 
       elab_context(arch);
       elab_context(tree_primary(arch));
+      elab_external_names(arch, &new_ctx);
 
       ghash_put(mc->instances, inst, ei);
       mc->unique++;
+
+      shareable = elab_can_share(arch, &new_ctx);
+      new_ctx.shareable = &shareable;
    }
    else
-      new_ctx.cloned = tree_ident(ei->block);
+      elab_clone_instance(ei, inst, mc, &new_ctx);
 
    elab_push_scope(arch, &new_ctx);
    elab_generics(ei->block, inst, &new_ctx);
@@ -2162,6 +2273,9 @@ static void elab_architecture(tree_t inst, tree_t arch, const elab_ctx_t *ctx)
    }
 
    elab_pop_scope(&new_ctx);
+
+   if (new_ctx.shareable != NULL)
+      ei->shareable = shareable;
 }
 
 static void elab_configuration(tree_t inst, tree_t unit, const elab_ctx_t *ctx)
@@ -2193,22 +2307,28 @@ static void elab_configuration(tree_t inst, tree_t unit, const elab_ctx_t *ctx)
    mod_cache_t *mc = elab_cached_module(tree_to_object(unit), &new_ctx);
    mc->count++;
 
+   bool shareable = false;
    elab_instance_t *ei = ghash_get(mc->instances, inst);
    if (ei == NULL) {
       ei = pool_calloc(ctx->pool, sizeof(elab_instance_t));
       ei->block = vhdl_config_instance(config, inst, new_ctx.dotted);
+      ei->inst  = inst;
 
       elab_bind_components(ei->block, ei->block);
       elab_fold_generics(ei->block, &new_ctx);
 
       elab_context(arch);
       elab_context(tree_primary(arch));
+      elab_external_names(arch, &new_ctx);
 
       ghash_put(mc->instances, inst, ei);
       mc->unique++;
+
+      shareable = elab_can_share(arch, &new_ctx);
+      new_ctx.shareable = &shareable;
    }
    else
-      new_ctx.cloned = tree_ident(ei->block);
+      elab_clone_instance(ei, inst, mc, &new_ctx);
 
    elab_push_scope(arch, &new_ctx);
    elab_generics(ei->block, inst, &new_ctx);
@@ -2222,6 +2342,9 @@ static void elab_configuration(tree_t inst, tree_t unit, const elab_ctx_t *ctx)
    }
 
    elab_pop_scope(&new_ctx);
+
+   if (new_ctx.shareable != NULL)
+      ei->shareable = shareable;
 }
 
 static void elab_component(tree_t inst, tree_t comp, const elab_ctx_t *ctx)
@@ -2260,18 +2383,23 @@ static void elab_component(tree_t inst, tree_t comp, const elab_ctx_t *ctx)
    mod_cache_t *mc = elab_cached_module(tree_to_object(comp), &new_ctx);
    mc->count++;
 
+   bool shareable = false;
    elab_instance_t *ei = ghash_get(mc->instances, inst);
    if (ei == NULL) {
       ei = pool_calloc(ctx->pool, sizeof(elab_instance_t));
       ei->block = vhdl_component_instance(comp, inst, ndotted);
+      ei->inst  = inst;
 
       elab_fold_generics(ei->block, ctx);
 
       ghash_put(mc->instances, inst, ei);
       mc->unique++;
+
+      shareable = elab_can_share(comp, &new_ctx);
+      new_ctx.shareable = &shareable;
    }
    else
-      new_ctx.cloned = tree_ident(ei->block);
+      elab_clone_instance(ei, inst, mc, &new_ctx);
 
    tree_t b = tree_new(T_BLOCK);
    tree_set_ident(b, tree_ident(inst));
@@ -2290,6 +2418,9 @@ static void elab_component(tree_t inst, tree_t comp, const elab_ctx_t *ctx)
    }
 
    elab_pop_scope(&new_ctx);
+
+   if (new_ctx.shareable != NULL)
+      ei->shareable = shareable;
 }
 
 static void elab_instance(tree_t t, const elab_ctx_t *ctx)
@@ -2376,13 +2507,26 @@ static void elab_push_scope(tree_t t, elab_ctx_t *ctx)
    tree_set_ident(h, ctx->dotted);
    tree_set_ident2(h, ctx->cloned ?: ctx->dotted);
 
+   if (ctx->shared)
+      tree_set_flag(h, TREE_F_SHARED_UNIT);
+
    tree_add_decl(ctx->out, h);
 }
 
 static void elab_pop_scope(elab_ctx_t *ctx)
 {
-   if (ctx->lowered != NULL)
+   if (ctx->lowered != NULL) {
       unit_registry_finalise(ctx->registry, ctx->lowered);
+
+      if (ctx->stream != NULL && error_count() == 0)
+         cgen_stream_block(ctx->stream, ctx->out);
+   }
+
+   // A block can only be shared if every block below it would also
+   // be shared when it is cloned
+   const bool ok = ctx->shared || (ctx->shareable && *ctx->shareable);
+   if (!ok && ctx->parent != NULL && ctx->parent->shareable != NULL)
+      *ctx->parent->shareable = false;
 }
 
 static inline tree_t elab_eval_expr(tree_t t, const elab_ctx_t *ctx)
@@ -2824,8 +2968,8 @@ static void elab_print_stats(const elab_ctx_t *ctx)
 
    qsort(sorted, count, sizeof(mod_cache_t), elab_compar_modcache);
 
-   nvc_printf("\n$bold$%-50s %10s %10s$$\n", "Design Unit", "Instances",
-              "Unique");
+   nvc_printf("\n$bold$%-50s %10s %10s %10s$$\n", "Design Unit",
+              "Instances", "Unique", "Shared");
 
    for (int i = 0; i < count; i++) {
       ident_t name = NULL;
@@ -2838,15 +2982,16 @@ static void elab_print_stats(const elab_ctx_t *ctx)
       if (vlog != NULL)
          name = vlog_ident(vlog);
 
-      printf("%-50s %10d %10d\n", istr(name), sorted[i].count,
-             sorted[i].unique);
+      printf("%-50s %10d %10d %10d\n", istr(name), sorted[i].count,
+             sorted[i].unique, sorted[i].shared);
    }
 
    printf("\n");
 }
 
 tree_t elab(object_t *top, jit_t *jit, unit_registry_t *ur, mir_context_t *mc,
-            cover_data_t *cover, sdf_file_t *sdf, rt_model_t *m)
+            cover_data_t *cover, sdf_file_t *sdf, rt_model_t *m,
+            cgen_stream_t *cs)
 {
    make_new_arena();
 
@@ -2880,10 +3025,12 @@ tree_t elab(object_t *top, jit_t *jit, unit_registry_t *ur, mir_context_t *mc,
       .mir       = mc,
       .modcache  = hash_new(16),
       .mracache  = hash_new(16),
+      .depcache  = hset_new(64),
       .dotted    = lib_name(work),
       .model     = m,
       .scope     = create_scope(m, e, NULL),
       .pool      = pool_new(),
+      .stream    = cs,
    };
 
    if (vhdl != NULL)
@@ -2902,6 +3049,7 @@ tree_t elab(object_t *top, jit_t *jit, unit_registry_t *ur, mir_context_t *mc,
 
    hash_free(ctx.modcache);
    hash_free(ctx.mracache);
+   hset_free(ctx.depcache);
    pool_free(ctx.pool);
 
    if (error_count() > 0)
@@ -250,6 +250,19 @@ jit_handle_t jit_lazy_compile(jit_t *j, ident_t name)
    return jit_lazy_compile_locked(j, name);
 }
 
+void jit_alias(jit_t *j, ident_t name, jit_handle_t handle)
+{
+   jit_func_t *f = jit_get_func(j, handle);
+
+   SCOPED_LOCK(j->lock);
+
+   jit_func_t *exist = chash_get(j->index, name);
+   if (exist != NULL && exist != f)
+      fatal_trace("%s is already defined", istr(name));
+
+   chash_put(j->index, name, f);
+}
+
 jit_func_t *jit_get_func(jit_t *j, jit_handle_t handle)
 {
    assert(handle != JIT_HANDLE_INVALID);
@@ -277,6 +290,29 @@ static void jit_missing_unit(jit_func_t *f)
    __builtin_unreachable();
 }
 
+static bool jit_fill_from_pack(jit_func_t *f)
+{
+   jit_t *j = f->jit;
+
+   jit_pack_t *jp = load_acquire(&j->pack);
+   if (jp != NULL && jit_pack_fill(jp, j, f))
+      return true;
+
+   {
+      // Library and pack loading is not thread-safe
+      SCOPED_LOCK(j->lock);
+
+      if (j->pack == NULL)
+         store_release(&j->pack, jit_pack_new());
+
+      // Try the prebuilt code for the library containing this unit
+      if (!jit_pack_add_library(j->pack, f->name))
+         return false;
+   }
+
+   return jit_pack_fill(j->pack, j, f);
+}
+
 void jit_fill_irbuf(jit_func_t *f)
 {
    const func_state_t state = load_acquire(&(f->state));
@@ -311,7 +347,7 @@ void jit_fill_irbuf(jit_func_t *f)
    jit_transition(f->jit, oldstate, JIT_COMPILING);
 #endif
 
-   if (f->jit->pack != NULL && jit_pack_fill(f->jit->pack, f->jit, f))
+   if (jit_fill_from_pack(f))
       goto done;
 
    mir_unit_t *mu = mir_get_unit(f->jit->mir, f->name);
@@ -479,6 +515,34 @@ static void jit_emit_trace(diag_t *d, const loc_t *loc, object_t *enclosing,
    }
 }
 
+static void jit_fill_frame(jit_func_t *f, unsigned irpos, jit_frame_t *frame)
+{
+   frame->loc    = LOC_INVALID;
+   frame->symbol = f->name;
+   frame->object = NULL;
+
+#ifdef USE_EMUTLS
+   if (load_acquire(&f->state) == JIT_FUNC_COMPILING)
+      return;   // Cannot use jit_transition in jit_fill_irbuf
+#endif
+
+   jit_fill_irbuf(f);
+
+   frame->object = f->object;
+
+   // Scan backwards to find the last debug info
+   assert(irpos < f->nirs);
+   frame->loc = frame->object ? frame->object->loc : LOC_INVALID;
+   for (jit_ir_t *ir = &(f->irbuf[irpos]); ir >= f->irbuf; ir--) {
+      if (ir->op == J_DEBUG) {
+         frame->loc = ir->arg1.loc;
+         break;
+      }
+      else if (ir->target)
+         break;
+   }
+}
+
 jit_stack_trace_t *jit_stack_trace(void)
 {
    jit_thread_local_t *thread = jit_thread_local();
@@ -492,35 +556,30 @@ jit_stack_trace_t *jit_stack_trace(void)
    stack->count = count;
 
    jit_frame_t *frame = stack->frames;
-   for (jit_anchor_t *a = thread->anchor; a; a = a->caller, frame++) {
-      frame->loc    = LOC_INVALID;
-      frame->symbol = a->func->name;
-      frame->object = NULL;
-
-#ifdef USE_EMUTLS
-      if (load_acquire(&a->func->state) == JIT_FUNC_COMPILING)
-         continue;   // Cannot use jit_transition in jit_fill_irbuf
-#endif
+   for (jit_anchor_t *a = thread->anchor; a; a = a->caller, frame++)
+      jit_fill_frame(a->func, a->irpos, frame);
 
-      jit_fill_irbuf(a->func);
+   return stack;
+}
 
-      frame->object = a->func->object;
+unsigned jit_call_sites(jit_call_site_t *sites, unsigned max)
+{
+   jit_thread_local_t *thread = jit_thread_local();
 
-      // Scan backwards to find the last debug info
-      assert(a->irpos < a->func->nirs);
-      frame->loc = frame->object ? frame->object->loc : LOC_INVALID;
-      for (jit_ir_t *ir = &(a->func->irbuf[a->irpos]);
-           ir >= a->func->irbuf; ir--) {
-         if (ir->op == J_DEBUG) {
-            frame->loc = ir->arg1.loc;
-            break;
-         }
-         else if (ir->target)
-            break;
+   unsigned count = 0;
+   for (jit_anchor_t *a = thread->anchor; a; a = a->caller, count++) {
+      if (count < max) {
+         sites[count].func  = a->func;
+         sites[count].irpos = a->irpos;
       }
    }
 
-   return stack;
+   return count;
+}
+
+void jit_resolve_call_site(const jit_call_site_t *site, jit_frame_t *frame)
+{
+   jit_fill_frame((jit_func_t *)site->func, site->irpos, frame);
 }
 
 static void jit_diag_cb(diag_t *d, void *arg)
@@ -784,8 +843,23 @@ void jit_set_silent(jit_t *j, bool silent)
 
 void jit_load_pack(jit_t *j, FILE *f)
 {
-   assert(j->pack == NULL);
-   j->pack = jit_read_pack(f);
+   SCOPED_LOCK(j->lock);
+
+   if (j->pack == NULL)
+      store_release(&j->pack, jit_pack_new());
+
+   jit_pack_load(j->pack, f);
+}
+
+bool jit_is_prebuilt(jit_t *j, ident_t name)
+{
+   SCOPED_LOCK(j->lock);
+
+   if (j->pack == NULL)
+      store_release(&j->pack, jit_pack_new());
+
+   (void)jit_pack_add_library(j->pack, name);
+   return jit_pack_has(j->pack, name);
 }
 
 void jit_msg(const loc_t *where, diag_level_t level, const char *fmt, ...)
@@ -987,6 +1061,7 @@ jit_handle_t jit_assemble(jit_t *j, ident_t name, const char *text)
       { "$COPY",   MACRO_COPY,   1, 2 },
       { "$MOVE",   MACRO_MOVE,   1, 2 },
       { "$CASE",   MACRO_CASE,   1, 2 },
+      { "$SWITCH", MACRO_SWITCH, 1, 1 },
       { "$SALLOC", MACRO_SALLOC, 1, 2 },
       { "$LALLOC", MACRO_LALLOC, 1, 1 },
       { "$BZERO",  MACRO_BZERO,  1, 1 },
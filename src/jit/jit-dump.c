@@ -51,7 +51,7 @@ const char *jit_op_name(jit_op_t op)
          "$COPY", "$GALLOC", "$EXIT", "$FEXP", "$EXP", "$BZERO",
          "$GETPRIV", "$PUTPRIV", "$LALLOC", "$SALLOC", "$CASE",
          "$TRIM", "$MOVE", "$MEMSET", "$REEXEC", "$SADD", "$PACK",
-         "$UNPACK", "$VEC2OP", "$VEC4OP",
+         "$UNPACK", "$VEC2OP", "$VEC4OP", "$SWITCH",
       };
       assert(op - __MACRO_BASE < ARRAY_LEN(names));
       return names[op - __MACRO_BASE];
@@ -98,6 +98,7 @@ const char *jit_exit_name(jit_exit_t exit)
       "MAP_IMPLICIT", "BIND_EXTERNAL", "SYSCALL", "PUT_CONVERSION",
       "DIR_FAIL", "LEVEL_TRIGGER", "ENABLE_TRIGGER", "DISABLE_TRIGGER",
       "SCHED_DEPOSIT", "PUT_DRIVER", "SCHED_INACTIVE", "GET_COUNTERS",
+      "LAST_VALUE",
    };
    assert(exit < ARRAY_LEN(names));
    return names[exit];
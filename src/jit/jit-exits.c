@@ -1013,6 +1013,15 @@ void __nvc_do_exit(jit_exit_t which, jit_anchor_t *anchor, jit_scalar_t *args,
       }
       break;
 
+   case JIT_EXIT_LAST_VALUE:
+      {
+         sig_shared_t *shared = args[0].pointer;
+         uint32_t      offset = args[1].integer;
+
+         args[0].pointer = x_last_value(shared, offset);
+      }
+      break;
+
    default:
       fatal_trace("unhandled exit %s", jit_exit_name(which));
    }
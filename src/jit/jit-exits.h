@@ -63,6 +63,7 @@ void x_report(const uint8_t *msg, int32_t msg_len, int8_t severity,
               object_t *where);
 int64_t x_last_event(sig_shared_t *ss, uint32_t offset, int32_t count);
 int64_t x_last_active(sig_shared_t *ss, uint32_t offset, int32_t count);
+void *x_last_value(sig_shared_t *ss, uint32_t offset);
 void x_map_signal(sig_shared_t *src_ss, uint32_t src_offset,
                   sig_shared_t *dst_ss, uint32_t dst_offset, uint32_t count);
 void x_map_const(sig_shared_t *ss, uint32_t offset,
@@ -116,5 +117,9 @@ void x_instance_name(attr_kind_t kind, text_buf_t *tb);
 void x_enable_trigger(rt_trigger_t *trigger);
 void x_disable_trigger(rt_trigger_t *trigger);
 int32_t *x_get_counters(jit_handle_t handle);
+void x_display(const uint8_t *prog, const jit_scalar_t *args);
+void x_monitor(const ffi_closure_t *closure, sig_shared_t **signals,
+               int count);
+void x_strobe(const ffi_closure_t *closure);
 
 #endif  // _JIT_EXITS_H
@@ -16,8 +16,10 @@
 //
 
 #include "util.h"
+#include "common.h"
 #include "hash.h"
 #include "ident.h"
+#include "jit/jit-exits.h"
 #include "jit/jit-ffi.h"
 #include "jit/jit-priv.h"
 #include "jit/jit.h"
@@ -514,6 +516,55 @@ void jit_do_syscall(vlog_node_t where, jit_anchor_t *caller, jit_scalar_t *args,
                     tlab_t *tlab)
 {
    ident_t name = vlog_ident(where);
+
+   switch (is_well_known(name)) {
+   case W_DLR_DISPLAY:
+   case W_DLR_WRITE:
+      // Lowered to a precompiled format program
+      x_display(args[1].pointer, args + 2);
+      return;
+   case W_DLR_MONITOR:
+      if (args[1].pointer != NULL)
+         x_display(args[1].pointer, args + 2);   // From the deferred function
+      else {
+         const ffi_closure_t closure = { args[2].integer, args[3].pointer };
+         const int count = args[4].integer;
+
+         sig_shared_t **signals LOCAL =
+            xmalloc_array(count, sizeof(sig_shared_t *));
+
+         // Signals that do not fit in the argument registers are
+         // spilled to a buffer passed in the last register
+         const jit_scalar_t *spill = NULL;
+         for (int i = 0, pslot = 5; i < count; i++) {
+            if (spill == NULL && pslot + 2 >= JIT_MAX_ARGS - 1)
+               spill = args[JIT_MAX_ARGS - 1].pointer;
+
+            if (spill != NULL) {
+               signals[i] = spill[0].pointer;
+               spill += 2;
+            }
+            else {
+               signals[i] = args[pslot].pointer;
+               pslot += 2;
+            }
+         }
+
+         x_monitor(&closure, signals, count);
+      }
+      return;
+   case W_DLR_STROBE:
+      if (args[1].pointer != NULL)
+         x_display(args[1].pointer, args + 2);   // From the deferred function
+      else {
+         const ffi_closure_t closure = { args[2].integer, args[3].pointer };
+         x_strobe(&closure);
+      }
+      return;
+   default:
+      break;
+   }
+
    vpiHandle handle = vpi_bind_foreign(name, where);
    if (handle == NULL)
       jit_msg(NULL, DIAG_FATAL, "system task %s not registered", istr(name));
@@ -864,6 +864,44 @@ static void interp_case(jit_interp_t *state, jit_ir_t *ir)
       interp_branch_to(state, ir->arg2);
 }
 
+static void interp_switch(jit_interp_t *state, jit_ir_t *ir)
+{
+   const int64_t test = state->regs[ir->result].integer;
+   const int count = ir->arg1.int64;
+
+   // The following COUNT $CASE entries are sorted by value
+   jit_ir_t *table = state->func->irbuf + state->pc;
+   JIT_ASSERT(state->pc + count < state->func->nirs);
+   JIT_ASSERT(table[0].op == MACRO_CASE && table[count - 1].op == MACRO_CASE);
+
+   const int64_t low = table[0].arg1.int64;
+   const int64_t high = table[count - 1].arg1.int64;
+
+   if (test < low || test > high)
+      state->pc += count;
+   else if ((uint64_t)high - (uint64_t)low == count - 1) {
+      // Dense table can be indexed directly
+      JIT_ASSERT(table[test - low].arg1.int64 == test);
+      interp_branch_to(state, table[test - low].arg2);
+   }
+   else {
+      for (int lo = 0, hi = count - 1; lo <= hi; ) {
+         const int mid = (lo + hi) / 2;
+         const int64_t cmp = table[mid].arg1.int64;
+         if (cmp == test) {
+            interp_branch_to(state, table[mid].arg2);
+            return;
+         }
+         else if (cmp < test)
+            lo = mid + 1;
+         else
+            hi = mid - 1;
+      }
+
+      state->pc += count;
+   }
+}
+
 static void interp_trim(jit_interp_t *state, jit_ir_t *ir)
 {
    assert(state->tlab->alloc >= state->anchor->watermark);
@@ -1070,6 +1108,9 @@ static void interp_loop(jit_interp_t *state)
       case MACRO_CASE:
          interp_case(state, ir);
          break;
+      case MACRO_SWITCH:
+         interp_switch(state, ir);
+         break;
       case MACRO_TRIM:
          interp_trim(state, ir);
          break;
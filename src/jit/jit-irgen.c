@@ -43,6 +43,7 @@ typedef A(jit_value_t) value_list_t;
 #define PATCH_CHUNK_SZ  4
 #define MAX_STACK_ALLOC 65536
 #define DEDUP_PREFIX    16384
+#define SWITCH_MIN_CASE 4
 
 struct _patch_list {
    patch_list_t *next;
@@ -698,6 +699,13 @@ static void macro_case(jit_irgen_t *g, jit_value_t test, jit_value_t cmp,
    irgen_patch_label(g, ir, l);
 }
 
+static void macro_switch(jit_irgen_t *g, jit_value_t test, int count)
+{
+   assert(test.kind == JIT_VALUE_REG);
+   irgen_emit_unary(g, MACRO_SWITCH, JIT_SZ_UNSPEC, JIT_CC_NONE, test.reg,
+                    jit_value_from_int64(count));
+}
+
 static void macro_trim(jit_irgen_t *g)
 {
    irgen_emit_nullary(g, MACRO_TRIM, JIT_CC_NONE, JIT_REG_INVALID);
@@ -2444,11 +2452,79 @@ static void irgen_op_cond(jit_irgen_t *g, mir_value_t n)
    }
 }
 
+typedef struct {
+   int64_t        cmp;
+   int            order;
+   irgen_label_t *label;
+} case_entry_t;
+
+static int case_entry_cmp(const void *a, const void *b)
+{
+   const case_entry_t *ea = a;
+   const case_entry_t *eb = b;
+
+   if (ea->cmp < eb->cmp)
+      return -1;
+   else if (ea->cmp > eb->cmp)
+      return 1;
+   else
+      return ea->order - eb->order;
+}
+
+static bool irgen_case_table(jit_irgen_t *g, mir_value_t n, jit_value_t value)
+{
+   // Large case statements with constant choices are emitted as a
+   // $SWITCH followed by a table of $CASE entries sorted by value which
+   // the interpreter and native backends can search in logarithmic or
+   // constant time
+
+   const int nargs = mir_count_args(g->mu, n);
+   const int ncases = (nargs - 2) / 2;
+   if (ncases < SWITCH_MIN_CASE)
+      return false;
+
+   case_entry_t *entries LOCAL = xmalloc_array(ncases, sizeof(case_entry_t));
+
+   for (int i = 0; i < ncases; i++) {
+      jit_value_t cmp = irgen_get_arg(g, n, 2 + i*2);
+      if (cmp.kind != JIT_VALUE_INT64)
+         return false;
+
+      mir_block_t b = mir_cast_block(mir_get_arg(g->mu, n, 3 + i*2));
+
+      entries[i].cmp   = cmp.int64;
+      entries[i].order = i;
+      entries[i].label = g->blocks[b.id];
+   }
+
+   qsort(entries, ncases, sizeof(case_entry_t), case_entry_cmp);
+
+   // Only the first occurrence of a duplicate choice can ever match
+   int count = 1;
+   for (int i = 1; i < ncases; i++) {
+      if (entries[i].cmp != entries[count - 1].cmp)
+         entries[count++] = entries[i];
+   }
+
+   macro_switch(g, value, count);
+
+   for (int i = 0; i < count; i++)
+      macro_case(g, value, jit_value_from_int64(entries[i].cmp),
+                 entries[i].label);
+
+   return true;
+}
+
 static void irgen_op_case(jit_irgen_t *g, mir_value_t n)
 {
    jit_value_t value = irgen_get_arg(g, n, 0);
    mir_block_t def = mir_cast_block(mir_get_arg(g->mu, n, 1));
 
+   if (irgen_case_table(g, n, value)) {
+      j_jump(g, JIT_CC_NONE, g->blocks[def.id]);
+      return;
+   }
+
    const int nargs = mir_count_args(g->mu, n);
    for (int i = 2; i < nargs; i += 2) {
       jit_value_t cmp = irgen_get_arg(g, n, i);
@@ -3418,14 +3494,31 @@ static void irgen_op_last_value(jit_irgen_t *g, mir_value_t n)
    jit_value_t shared = irgen_get_arg_slot(g, n, 0, 0);
    jit_value_t offset = irgen_get_arg_slot(g, n, 0, 1);
 
+   jit_value_t flags = irgen_alloc_temp(g);
+   j_load(g, JIT_SZ_32, flags, jit_addr_from_value(shared, 4));
+
+   jit_value_t lastbit = jit_value_from_int64(SIG_F_LAST_VALUE);
+   jit_value_t lastflag = irgen_alloc_temp(g);
+   j_and(g, lastflag, flags, lastbit);
+
+   irgen_label_t *l_slow = irgen_alloc_label(g);
+   irgen_label_t *l_cont = irgen_alloc_label(g);
+
+   j_cmp(g, JIT_CC_EQ, lastflag, jit_value_from_int64(0));
+   j_jump(g, JIT_CC_T, l_slow);
+
+   // The last value follows the effective and driving values
    jit_value_t data_ptr = irgen_alloc_temp(g);
    irgen_lea(g, data_ptr, jit_addr_from_value(shared, 8));
 
    jit_value_t size = irgen_alloc_temp(g);
    j_load(g, JIT_SZ_32, size, jit_addr_from_value(shared, 0));
 
+   jit_value_t size2 = irgen_alloc_temp(g);
+   j_shl(g, size2, size, jit_value_from_int64(1));
+
    jit_value_t last_value = g->map[n.id];
-   j_add(g, last_value, data_ptr, size);
+   j_add(g, last_value, data_ptr, size2);
 
    mir_type_t type = mir_get_elem(g->mu, mir_get_type(g->mu, n));
 
@@ -3433,6 +3526,18 @@ static void irgen_op_last_value(jit_irgen_t *g, mir_value_t n)
    jit_value_t scaled = irgen_alloc_temp(g);
    j_mul(g, scaled, offset, jit_value_from_int64(scale));
    j_add(g, last_value, last_value, scaled);
+
+   j_jump(g, JIT_CC_NONE, l_cont);
+
+   irgen_bind_label(g, l_slow);
+
+   j_send(g, 0, shared);
+   j_send(g, 1, offset);
+   macro_exit(g, JIT_EXIT_LAST_VALUE);
+
+   j_recv(g, last_value, 0);
+
+   irgen_bind_label(g, l_cont);
 }
 
 static void irgen_op_sched_waveform(jit_irgen_t *g, mir_value_t n)
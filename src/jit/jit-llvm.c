@@ -2480,6 +2480,8 @@ static void cgen_ir(llvm_obj_t *obj, cgen_block_t *cgb, jit_ir_t *ir)
    case MACRO_CASE:
       cgen_macro_case(obj, cgb, ir);
       break;
+   case MACRO_SWITCH:
+      break;   // The following $CASE entries are combined into a switch
    case MACRO_TRIM:
       cgen_macro_trim(obj, cgb, ir);
       break;
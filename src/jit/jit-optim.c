@@ -77,12 +77,14 @@ static jit_reg_t cfg_get_reg(jit_value_t value)
 static inline bool cfg_reads_result(jit_ir_t *ir)
 {
    return ir->op == MACRO_COPY || ir->op == MACRO_CASE || ir->op == MACRO_BZERO
-      || ir->op == MACRO_MOVE || ir->op == MACRO_MEMSET;
+      || ir->op == MACRO_MOVE || ir->op == MACRO_MEMSET
+      || ir->op == MACRO_SWITCH;
 }
 
 static inline bool cfg_writes_result(jit_ir_t *ir)
 {
-   return ir->result != JIT_REG_INVALID && ir->op != MACRO_CASE;
+   return ir->result != JIT_REG_INVALID && ir->op != MACRO_CASE
+      && ir->op != MACRO_SWITCH;
 }
 
 static void cfg_liveness(jit_cfg_t *cfg, jit_func_t *f)
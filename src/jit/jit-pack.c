@@ -23,6 +23,7 @@
 #include "jit/jit-priv.h"
 #include "lib.h"
 #include "object.h"
+#include "thread.h"
 
 #include <assert.h>
 #include <stdlib.h>
@@ -38,24 +39,39 @@ typedef struct {
    loc_t          last_loc;
 } pack_func_t;
 
+typedef struct {
+   void   *mmap;
+   size_t  size;
+} pack_map_t;
+
 struct _jit_pack {
-   chash_t    *funcs;
-   ZSTD_DCtx  *zstd;
-   const void *mmap;
-   size_t      map_size;
-   nvc_lock_t  zlock;
+   chash_t        *funcs;
+   ZSTD_DCtx      *zstd;
+   A(pack_map_t)   maps;
+   hset_t         *libs;
+   nvc_lock_t      zlock;
 };
 
 typedef struct _pack_writer {
-   text_buf_t *strtab;
-   shash_t    *strhash;
-   size_t      bufsz;
-   uint8_t    *wptr;
-   uint8_t    *buf;
-   ZSTD_CCtx  *zstd;
-   loc_t       last_loc;
+   text_buf_t    *strtab;
+   shash_t       *strhash;
+   size_t         bufsz;
+   uint8_t       *wptr;
+   uint8_t       *buf;
+   ZSTD_CCtx     *zstd;
+   loc_t          last_loc;
+   pack_writer_t *parent;
 } pack_writer_t;
 
+typedef struct {
+   jit_handle_t  handle;
+   unsigned      name;
+   uint8_t      *buf;
+   size_t        size;
+} pack_entry_t;
+
+#define PACK_BATCH 1024
+
 ////////////////////////////////////////////////////////////////////////////////
 // JIT bytecode serialisation
 
@@ -267,27 +283,93 @@ static void pack_func(pack_writer_t *pw, jit_t *j, jit_func_t *f)
    }
 }
 
-pack_writer_t *pack_writer_new(void)
+static void pack_intern_locus(pack_writer_t *pw, object_t *obj)
+{
+   if (obj != NULL) {
+      ident_t module;
+      ptrdiff_t offset;
+      object_locus(obj, &module, &offset);
+
+      (void)pack_writer_get_string(pw, istr(module));
+   }
+}
+
+static void pack_intern_func(pack_writer_t *pw, jit_t *j, jit_func_t *f)
+{
+   // Add every string referenced by pack_func in the same order so the
+   // string table is identical to encoding the function serially
+   for (int i = 0; i < f->nvars; i++)
+      (void)pack_writer_get_string(pw, istr(f->linktab[i].name));
+
+   pack_intern_locus(pw, f->object);
+
+   for (int i = 0; i < f->nirs; i++) {
+      const jit_value_t args[] = { f->irbuf[i].arg1, f->irbuf[i].arg2 };
+      for (int k = 0; k < ARRAY_LEN(args); k++) {
+         switch (args[k].kind) {
+         case JIT_VALUE_HANDLE:
+            if (args[k].handle != JIT_HANDLE_INVALID) {
+               jit_func_t *callee = jit_get_func(j, args[k].handle);
+               (void)pack_writer_get_string(pw, istr(callee->name));
+            }
+            break;
+         case JIT_VALUE_LOC:
+            (void)pack_writer_get_string(pw, loc_file_str(&(args[k].loc)));
+            break;
+         case JIT_VALUE_LOCUS:
+            pack_intern_locus(pw, args[k].locus);
+            break;
+         default:
+            break;
+         }
+      }
+   }
+}
+
+static pack_writer_t *pack_writer_alloc(void)
 {
    pack_writer_t *pw = xcalloc(sizeof(pack_writer_t));
-   pw->strhash = shash_new(16);
-   pw->strtab  = tb_new();
-   pw->bufsz   = 512;
-   pw->buf     = xmalloc(pw->bufsz);
-   pw->wptr    = pw->buf;
+   pw->bufsz = 512;
+   pw->buf   = xmalloc(pw->bufsz);
+   pw->wptr  = pw->buf;
 
    if ((pw->zstd = ZSTD_createCCtx()) == NULL)
       fatal_trace("ZSTD_createCCtx failed");
 
+   return pw;
+}
+
+pack_writer_t *pack_writer_new(void)
+{
+   pack_writer_t *pw = pack_writer_alloc();
+   pw->strhash = shash_new(16);
+   pw->strtab  = tb_new();
+
    tb_append(pw->strtab, '\0');    // Null string is index zero
 
    return pw;
 }
 
+static pack_writer_t *pack_writer_fork(pack_writer_t *parent)
+{
+   // A forked writer has its own buffer and compression context but
+   // reads strings from the parent table which must not be modified
+   pack_writer_t *pw = pack_writer_alloc();
+   pw->parent = parent;
+
+   return pw;
+}
+
 unsigned pack_writer_get_string(pack_writer_t *pw, const char *str)
 {
    if (str == NULL)
       return 0;
+   else if (pw->parent != NULL) {
+      const uintptr_t exist = (uintptr_t)shash_get(pw->parent->strhash, str);
+      if (exist == 0)
+         fatal_trace("string %s missing from pack string table", str);
+      return exist;
+   }
 
    const uintptr_t exist = (uintptr_t)shash_get(pw->strhash, str);
    if (exist != 0)
@@ -344,8 +426,12 @@ void pack_writer_free(pack_writer_t *pw)
 {
    ZSTD_freeCCtx(pw->zstd);
    free(pw->buf);
-   tb_free(pw->strtab);
-   shash_free(pw->strhash);
+
+   if (pw->parent == NULL) {
+      tb_free(pw->strtab);
+      shash_free(pw->strhash);
+   }
+
    free(pw);
 }
 
@@ -356,6 +442,7 @@ jit_pack_t *jit_pack_new(void)
 {
    jit_pack_t *jp = xcalloc(sizeof(struct _jit_pack));
    jp->funcs = chash_new(256);
+   jp->libs  = hset_new(16);
 
    if ((jp->zstd = ZSTD_createDCtx()) == NULL)
       fatal_trace("ZSTD_createDCtx failed");
@@ -371,9 +458,11 @@ static void pack_func_free(const void *key, void *value)
 
 void jit_pack_free(jit_pack_t *jp)
 {
-   if (jp->mmap != NULL)
-      unmap_file((void *)jp->mmap, jp->map_size);
+   for (int i = 0; i < jp->maps.count; i++)
+      unmap_file(jp->maps.items[i].mmap, jp->maps.items[i].size);
 
+   ACLEAR(jp->maps);
+   hset_free(jp->libs);
    ZSTD_freeDCtx(jp->zstd);
    chash_iter(jp->funcs, pack_func_free);
    chash_free(jp->funcs);
@@ -383,7 +472,8 @@ void jit_pack_free(jit_pack_t *jp)
 void jit_pack_put(jit_pack_t *jp, ident_t name, const uint8_t *cpool,
                   const char *strtab, const uint8_t *buf)
 {
-   assert(chash_get(jp->funcs, name) == NULL);
+   if (chash_get(jp->funcs, name) != NULL)
+      return;   // Already loaded from another pack
 
    pack_func_t *pf = xcalloc(sizeof(pack_func_t));
    pf->buf    = buf;
@@ -520,6 +610,11 @@ static jit_value_t unpack_value(pack_func_t *pf, jit_t *j)
    return value;
 }
 
+bool jit_pack_has(jit_pack_t *jp, ident_t name)
+{
+   return chash_get(jp->funcs, name) != NULL;
+}
+
 bool jit_pack_fill(jit_pack_t *jp, jit_t *j, jit_func_t *f)
 {
    pack_func_t *pf = chash_get(jp->funcs, f->name);
@@ -616,76 +711,166 @@ static void write_fully(const void *buf, size_t size, FILE *f)
       fatal_errno("fwrite");
 }
 
-void jit_write_pack(jit_t *j, const ident_t *units, size_t count, FILE *f)
+struct _jit_pack_stream {
+   jit_t              *jit;
+   FILE               *file;
+   pack_writer_t      *writer;
+   workq_t            *workq;
+   A(pack_entry_t)     entries;
+   pack_writer_t      *forks[MAX_THREADS];
+};
+
+static void pack_encode_cb(void *context, void *arg)
 {
-   pack_writer_t *pw = pack_writer_new();
+   jit_pack_stream_t *ps = context;
+   pack_entry_t *e = arg;
 
-   pack_header_t header = {};
-   write_fully(&header, sizeof(header), f);
+   // Each thread only ever touches its own slot
+   pack_writer_t **pw = &(ps->forks[thread_id()]);
+   if (*pw == NULL)
+      *pw = pack_writer_fork(ps->writer);
+
+   pack_writer_emit(*pw, ps->jit, e->handle, &e->buf, &e->size);
+}
+
+static void pack_write_entry(jit_pack_stream_t *ps, pack_entry_t *e)
+{
+   uint8_t bytes[10];
+
+   const int name_nbytes = encode_number(e->name, bytes);
+   write_fully(bytes, name_nbytes, ps->file);
+
+   const int size_nbytes = encode_number(e->size, bytes);
+   write_fully(bytes, size_nbytes, ps->file);
+
+   jit_func_t *func = jit_get_func(ps->jit, e->handle);
+
+   const int cpool_nbytes = encode_number(func->cpoolsz, bytes);
+   write_fully(bytes, cpool_nbytes, ps->file);
+
+   write_fully(e->buf, e->size, ps->file);
+   free(e->buf);
+   e->buf = NULL;
+
+   if (func->cpoolsz > 0)
+      write_fully(func->cpool, func->cpoolsz, ps->file);
+}
 
-   for (size_t i = 0; i < count; i++) {
-      jit_handle_t handle = jit_compile(j, units[i]);
+jit_pack_stream_t *jit_pack_stream_new(jit_t *j, FILE *f)
+{
+   jit_pack_stream_t *ps = xcalloc(sizeof(jit_pack_stream_t));
+   ps->jit    = j;
+   ps->file   = f;
+   ps->writer = pack_writer_new();
+   ps->workq  = workq_new(ps);
+
+   return ps;
+}
 
-      uint8_t bytes[10];
+void jit_pack_stream_put(jit_pack_stream_t *ps, ident_t unit)
+{
+   // Encoding is deferred until the stream is closed when the object
+   // arenas referenced by the code are frozen
+   pack_entry_t e = {
+      .handle = jit_compile(ps->jit, unit),
+   };
+   APUSH(ps->entries, e);
+}
 
-      const uint32_t name = pack_writer_get_string(pw, istr(units[i]));
-      const int name_nbytes = encode_number(name, bytes);
-      write_fully(bytes, name_nbytes, f);
+void jit_pack_stream_close(jit_pack_stream_t *ps)
+{
+   // The header is rewritten with the string table offset at the end
+   pack_header_t header = {};
+   write_fully(&header, sizeof(header), ps->file);
 
-      uint8_t *buf;
-      size_t size;
-      pack_writer_emit(pw, j, handle, &buf, &size);
+   // Strings are added to the table on the main thread in unit order
+   // so the file contents do not depend on the number of threads
+   for (int i = 0; i < ps->entries.count; i++) {
+      pack_entry_t *e = &(ps->entries.items[i]);
+      jit_func_t *f = jit_get_func(ps->jit, e->handle);
+      jit_fill_irbuf(f);
 
-      const int size_nbytes = encode_number(size, bytes);
-      write_fully(bytes, size_nbytes, f);
+      e->name = pack_writer_get_string(ps->writer, istr(f->name));
+      pack_intern_func(ps->writer, ps->jit, f);
+   }
 
-      jit_func_t *func = jit_get_func(j, handle);
+   // Encode and compress each batch of functions in parallel and then
+   // write them out in the original order
+   for (int base = 0; base < ps->entries.count; base += PACK_BATCH) {
+      const int limit = MIN(base + PACK_BATCH, ps->entries.count);
 
-      const int cpool_nbytes = encode_number(func->cpoolsz, bytes);
-      write_fully(bytes, cpool_nbytes, f);
+      for (int i = base; i < limit; i++)
+         workq_do(ps->workq, pack_encode_cb, &(ps->entries.items[i]));
 
-      write_fully(buf, size, f);
-      free(buf);
+      workq_start(ps->workq);
+      workq_drain(ps->workq);
 
-      if (func->cpoolsz > 0)
-         write_fully(func->cpool, func->cpoolsz, f);
+      for (int i = base; i < limit; i++)
+         pack_write_entry(ps, &(ps->entries.items[i]));
    }
 
    memcpy(header.magic, PACK_MAGIC, sizeof(header.magic));
-   header.strtab = ftell(f);
+   header.strtab = ftell(ps->file);
 
    const char *tab;
    size_t size;
-   pack_writer_string_table(pw, &tab, &size);
+   pack_writer_string_table(ps->writer, &tab, &size);
 
-   write_fully(tab, size, f);
+   write_fully(tab, size, ps->file);
 
-   rewind(f);
+   rewind(ps->file);
 
-   write_fully(&header, sizeof(header), f);
+   write_fully(&header, sizeof(header), ps->file);
 
-   pack_writer_free(pw);
+   jit_pack_stream_discard(ps);
 }
 
-jit_pack_t *jit_read_pack(FILE *f)
+void jit_pack_stream_discard(jit_pack_stream_t *ps)
 {
-   jit_pack_t *jp = jit_pack_new();
+   for (int i = 0; i < MAX_THREADS; i++) {
+      if (ps->forks[i] != NULL)
+         pack_writer_free(ps->forks[i]);
+   }
+
+   workq_free(ps->workq);
+   for (int i = 0; i < ps->entries.count; i++)
+      free(ps->entries.items[i].buf);
 
+   pack_writer_free(ps->writer);
+   ACLEAR(ps->entries);
+   free(ps);
+}
+
+void jit_write_pack(jit_t *j, const ident_t *units, size_t count, FILE *f)
+{
+   jit_pack_stream_t *ps = jit_pack_stream_new(j, f);
+
+   for (size_t i = 0; i < count; i++)
+      jit_pack_stream_put(ps, units[i]);
+
+   jit_pack_stream_close(ps);
+}
+
+void jit_pack_load(jit_pack_t *jp, FILE *f)
+{
    file_info_t info;
    if (!get_handle_info(fileno(f), &info))
       fatal("cannot get info for pack file");
 
-   jp->mmap = map_file(fileno(f), info.size);
-   jp->map_size = info.size;
+   pack_map_t map = {
+      .mmap = map_file(fileno(f), info.size),
+      .size = info.size,
+   };
+   APUSH(jp->maps, map);
 
-   const pack_header_t *header = jp->mmap;
+   const pack_header_t *header = map.mmap;
    if (memcmp(header->magic, PACK_MAGIC, sizeof(header->magic)) != 0)
       fatal("bad JIT pack magic");
 
-   const char *strtab = jp->mmap + header->strtab;
+   const char *strtab = map.mmap + header->strtab;
 
-   const uint8_t *rptr = jp->mmap + sizeof(pack_header_t);
-   while (rptr < (uint8_t *)jp->mmap + header->strtab) {
+   const uint8_t *rptr = map.mmap + sizeof(pack_header_t);
+   while (rptr < (uint8_t *)map.mmap + header->strtab) {
       const uint32_t str = decode_number(&rptr);
       const uint32_t size = decode_number(&rptr);
       const uint32_t cpool = decode_number(&rptr);
@@ -695,6 +880,34 @@ jit_pack_t *jit_read_pack(FILE *f)
 
       rptr += size + cpool;
    }
+}
+
+bool jit_pack_add_library(jit_pack_t *jp, ident_t name)
+{
+   // Units in design libraries are named LIB.UNIT or LIB.UNIT.SUFFIX
+   ident_t lname = ident_until(name, '.');
+   if (lname == name || hset_contains(jp->libs, lname))
+      return false;
+
+   hset_insert(jp->libs, lname);
+
+   // Units in the work library may be modified by the current process
+   lib_t lib = lib_find(lname);
+   if (lib == NULL || lib == lib_work() || lib_path(lib) == NULL)
+      return false;
+
+   FILE *f = lib_fopen(lib, LIB_JIT_PACK, "rb");
+   if (f == NULL)
+      return false;
 
+   jit_pack_load(jp, f);
+   fclose(f);
+   return true;
+}
+
+jit_pack_t *jit_read_pack(FILE *f)
+{
+   jit_pack_t *jp = jit_pack_new();
+   jit_pack_load(jp, f);
    return jp;
 }
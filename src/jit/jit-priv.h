@@ -91,6 +91,7 @@ typedef enum {
    MACRO_UNPACK,
    MACRO_VEC2OP,
    MACRO_VEC4OP,
+   MACRO_SWITCH,
 } jit_op_t;
 
 typedef enum {
@@ -185,6 +186,7 @@ typedef enum {
    JIT_EXIT_PUT_DRIVER,
    JIT_EXIT_SCHED_INACTIVE,
    JIT_EXIT_GET_COUNTERS,
+   JIT_EXIT_LAST_VALUE,
 } jit_exit_t;
 
 typedef uint16_t jit_reg_t;
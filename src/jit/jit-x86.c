@@ -165,6 +165,7 @@ typedef enum {
    X86_CMP_EQ = 0x04,
    X86_CMP_NE = 0x05,
    X86_CMP_BE = 0x06,
+   X86_CMP_A  = 0x07,
    X86_CMP_LE = 0x0e,
    X86_CMP_LT = 0x0c,
    X86_CMP_GE = 0x0d,
@@ -230,6 +231,8 @@ typedef enum {
 #define JLT(addr) asm_jcc(blob, (addr), X86_CMP_LT)
 #define JB(addr) asm_jcc(blob, (addr), X86_CMP_C)
 #define JBE(addr) asm_jcc(blob, (addr), X86_CMP_BE)
+#define JA(addr) asm_jcc(blob, (addr), X86_CMP_A)
+#define JGT(addr) asm_jcc(blob, (addr), X86_CMP_GT)
 #define MULSD(dst, src) asm_mulsd(blob, (dst), (src))
 #define DIVSD(dst, src) asm_divsd(blob, (dst), (src))
 #define ADDSD(dst, src) asm_addsd(blob, (dst), (src))
@@ -2016,6 +2019,92 @@ static void jit_x86_macro_case(code_blob_t *blob, jit_ir_t *ir,
    code_blob_patch(blob, ir->arg2.label, jit_x86_patch);
 }
 
+static void jit_x86_patch_abs(code_blob_t *blob, jit_label_t label,
+                              uint8_t *wptr, const uint8_t *dest)
+{
+   const uintptr_t abs = (uintptr_t)dest;
+   for (int i = 0; i < 8; i++)
+      *(wptr - 8 + i) = (abs >> (i * 8)) & 0xff;
+}
+
+static void jit_x86_switch_search(code_blob_t *blob, jit_ir_t *table,
+                                  int low, int high, jit_label_t miss,
+                                  jit_label_t base)
+{
+   // Binary search over sorted $CASE entries with the test value in RAX
+
+   if (high - low < 4) {
+      for (int i = low; i <= high; i++) {
+         MOV(__ECX, IMM(table[i].arg1.int64), __QWORD);
+         CMP(__EAX, __ECX, __QWORD);
+         JZ(PATCH(INT32_MAX));
+         code_blob_patch(blob, table[i].arg2.label, jit_x86_patch);
+      }
+
+      JMP(PATCH(INT32_MAX));
+      code_blob_patch(blob, miss, jit_x86_patch);
+   }
+   else {
+      const int mid = (low + high) / 2;
+
+      MOV(__ECX, IMM(table[mid].arg1.int64), __QWORD);
+      CMP(__EAX, __ECX, __QWORD);
+      JZ(PATCH(INT32_MAX));
+      code_blob_patch(blob, table[mid].arg2.label, jit_x86_patch);
+      JGT(PATCH(INT32_MAX));
+      code_blob_patch(blob, base + mid, jit_x86_patch);
+
+      jit_x86_switch_search(blob, table, low, mid - 1, miss, base);
+
+      code_blob_mark(blob, base + mid);
+      jit_x86_switch_search(blob, table, mid + 1, high, miss, base);
+   }
+}
+
+static void jit_x86_macro_switch(code_blob_t *blob, jit_ir_t *ir,
+                                 const phys_slot_t *slots)
+{
+   jit_x86_get_reg(blob, __EAX, ir->result, slots);
+
+   const int count = ir->arg1.int64;
+   jit_ir_t *table = ir + 1;
+
+   const int64_t low = table[0].arg1.int64;
+   const int64_t high = table[count - 1].arg1.int64;
+
+   // Labels for code inside the switch are allocated after the last IR
+   // position and are unique as the tables for each $SWITCH do not
+   // overlap
+   const int this = ir - blob->func->irbuf;
+   const jit_label_t miss = blob->func->nirs + this;
+   const jit_label_t base = miss + 1;
+
+   if ((uint64_t)high - (uint64_t)low == count - 1) {
+      // Dense table of absolute jump targets indexed by test value
+      if (low != 0) {
+         MOV(__ECX, IMM(low), __QWORD);
+         SUB(__EAX, __ECX, __QWORD);
+      }
+
+      MOV(__ECX, IMM(count - 1), __QWORD);
+      CMP(__EAX, __ECX, __QWORD);
+      JA(PATCH(INT32_MAX));
+      code_blob_patch(blob, miss, jit_x86_patch);
+
+      __(0x48, 0x8d, 0x0d, 0x03, 0x00, 0x00, 0x00);   // LEA RCX, [RIP+3]
+      __(0xff, 0x24, 0xc1);                           // JMP [RCX+RAX*8]
+
+      for (int i = 0; i < count; i++) {
+         __(0, 0, 0, 0, 0, 0, 0, 0);
+         code_blob_patch(blob, table[i].arg2.label, jit_x86_patch_abs);
+      }
+   }
+   else
+      jit_x86_switch_search(blob, table, 0, count - 1, miss, base);
+
+   code_blob_mark(blob, miss);
+}
+
 static void jit_x86_macro_exp(code_blob_t *blob, jit_ir_t *ir,
                               const phys_slot_t *slots)
 {
@@ -2201,6 +2290,9 @@ static void jit_x86_op(code_blob_t *blob, jit_x86_state_t *state, jit_ir_t *ir,
    case MACRO_CASE:
       jit_x86_macro_case(blob, ir, slots);
       break;
+   case MACRO_SWITCH:
+      jit_x86_macro_switch(blob, ir, slots);
+      break;
    case MACRO_EXP:
       jit_x86_macro_exp(blob, ir, slots);
       break;
@@ -2308,6 +2400,11 @@ static void jit_x86_cgen(jit_t *j, jit_handle_t handle, void *context)
          code_blob_mark(blob, i);
       code_blob_print_ir(blob, &(f->irbuf[i]));
       jit_x86_op(blob, state, &(f->irbuf[i]), slots);
+
+      if (f->irbuf[i].op == MACRO_SWITCH) {
+         // The $CASE table was already consumed by the $SWITCH
+         i += f->irbuf[i].arg1.int64;
+      }
    }
 
    code_blob_mark(blob, JIT_LABEL_INVALID);
@@ -50,18 +50,25 @@ typedef struct {
    jit_frame_t frames[0];
 } jit_stack_trace_t;
 
+typedef struct {
+   const void *func;
+   unsigned    irpos;
+} jit_call_site_t;
+
 typedef void (*jit_irq_fn_t)(jit_t *, void *);
 
 jit_t *jit_new(unit_registry_t *ur, mir_context_t *mc);
 void jit_free(jit_t *j);
 jit_handle_t jit_compile(jit_t *j, ident_t name);
 jit_handle_t jit_lazy_compile(jit_t *j, ident_t name);
+void jit_alias(jit_t *j, ident_t name, jit_handle_t handle);
 jit_handle_t jit_assemble(jit_t *j, ident_t name, const char *text);
 void *jit_link(jit_t *j, jit_handle_t handle);
 void *jit_get_frame_var(jit_t *j, jit_handle_t handle, ident_t name);
 void jit_set_silent(jit_t *j, bool silent);
 mspace_t *jit_get_mspace(jit_t *j);
 void jit_load_pack(jit_t *j, FILE *f);
+bool jit_is_prebuilt(jit_t *j, ident_t name);
 bool jit_exit_status(jit_t *j, int *status);
 void jit_reset_exit_status(jit_t *j);
 void jit_add_tier(jit_t *j, int threshold, const jit_plugin_t *plugin);
@@ -76,6 +83,8 @@ bool jit_is_shutdown(jit_t *j);
 
 void *jit_mspace_alloc(size_t size) RETURNS_NONNULL;
 jit_stack_trace_t *jit_stack_trace(void);
+unsigned jit_call_sites(jit_call_site_t *sites, unsigned max);
+void jit_resolve_call_site(const jit_call_site_t *site, jit_frame_t *frame);
 jit_t *jit_for_thread(void);
 
 typedef void *(*thunk_result_fn_t)(jit_scalar_t *, void *);
@@ -99,6 +108,14 @@ void jit_pack_free(jit_pack_t *jp);
 
 void jit_write_pack(jit_t *j, const ident_t *units, size_t count, FILE *f);
 jit_pack_t *jit_read_pack(FILE *f);
+void jit_pack_load(jit_pack_t *jp, FILE *f);
+bool jit_pack_add_library(jit_pack_t *jp, ident_t name);
+bool jit_pack_has(jit_pack_t *jp, ident_t name);
+
+jit_pack_stream_t *jit_pack_stream_new(jit_t *j, FILE *f);
+void jit_pack_stream_put(jit_pack_stream_t *ps, ident_t unit);
+void jit_pack_stream_close(jit_pack_stream_t *ps);
+void jit_pack_stream_discard(jit_pack_stream_t *ps);
 
 __attribute__((format(printf, 3, 4)))
 void jit_msg(const loc_t *where, diag_level_t level, const char *fmt, ...);
@@ -1054,12 +1054,29 @@ ident_t lib_name(lib_t lib)
    return lib->name;
 }
 
+static fbuf_t *lib_fbuf_create(lib_t lib, const char *name,
+                               fbuf_cs_t csum, text_buf_t *tmp)
+{
+   // Write to a temporary file unique to this process which is later
+   // renamed over the real file with lib_fbuf_commit
+   tb_printf(tmp, "%s.%d.tmp", name, getpid());
+   return lib_fbuf_open(lib, tb_get(tmp), FBUF_OUT, csum);
+}
+
+static void lib_fbuf_commit(lib_t lib, const char *tmp, const char *name)
+{
+   LOCAL_TEXT_BUF from = lib_file_path(lib, tmp);
+   LOCAL_TEXT_BUF to = lib_file_path(lib, name);
+   replace_file(tb_get(from), tb_get(to));
+}
+
 static void lib_save_unit(lib_t lib, lib_unit_t *unit)
 {
    LOCAL_TEXT_BUF tb = tb_new();
    lib_encode_file_name(unit->name, tb);
 
-   fbuf_t *f = lib_fbuf_open(lib, tb_get(tb), FBUF_OUT, FBUF_CS_ADLER32);
+   LOCAL_TEXT_BUF tmp = tb_new();
+   fbuf_t *f = lib_fbuf_create(lib, tb_get(tb), FBUF_CS_ADLER32, tmp);
    if (f == NULL)
       fatal("failed to create %s in library %s", tb_get(tb), istr(lib->name));
 
@@ -1088,6 +1105,8 @@ static void lib_save_unit(lib_t lib, lib_unit_t *unit)
    uint32_t checksum;
    fbuf_close(f, &checksum);
 
+   lib_fbuf_commit(lib, tb_get(tmp), tb_get(tb));
+
    arena_set_checksum(arena, checksum);
 
    assert(unit->dirty);
@@ -1100,10 +1119,15 @@ void lib_save(lib_t lib)
 
    assert(lib->lock_fd != -1);   // Should not be called in unit tests
    lib_ensure_writable(lib);
-   file_write_lock(lib->lock_fd);
+
+   // Design units are written to a temporary file and then atomically
+   // renamed so any number of processes can save independent units
+   // into the same library while holding only a shared lock
+   file_read_lock(lib->lock_fd);
 
    freeze_global_arena();
 
+   bool changed = false;
    for (lib_unit_t *lu = lib->units; lu; lu = lu->next) {
       if (lu->dirty) {
          if (lu->error)
@@ -1113,10 +1137,21 @@ void lib_save(lib_t lib)
             arena_walk_obsolete_deps(object_arena(lu->object),
                                      lib_obsolete_cb, lu);
             lib_save_unit(lib, lu);
+            changed = true;
          }
       }
    }
 
+   file_unlock(lib->lock_fd);
+
+   // The exclusive lock is only held while merging our entries into
+   // the shared index
+   file_write_lock(lib->lock_fd);
+
+   // Any prebuilt JIT code for the library may now be out of date
+   if (changed)
+      lib_delete(lib, LIB_JIT_PACK);
+
    LOCAL_TEXT_BUF index_path = lib_file_path(lib, "_index");
    file_info_t info;
    if (get_file_info(tb_get(index_path), &info)) {
@@ -1129,7 +1164,8 @@ void lib_save(lib_t lib)
 
    int index_sz = lib_index_size(lib);
 
-   fbuf_t *f = lib_fbuf_open(lib, "_index", FBUF_OUT, FBUF_CS_NONE);
+   LOCAL_TEXT_BUF tmp = tb_new();
+   fbuf_t *f = lib_fbuf_create(lib, "_index", FBUF_CS_NONE, tmp);
    if (f == NULL)
       fatal_errno("failed to create library %s index", istr(lib->name));
 
@@ -1146,6 +1182,8 @@ void lib_save(lib_t lib)
    ident_write_end(ictx);
    fbuf_close(f, NULL);
 
+   lib_fbuf_commit(lib, tb_get(tmp), "_index");
+
    if (!get_file_info(tb_get(index_path), &info))
       fatal_errno("%s", tb_get(index_path));
 
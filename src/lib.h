@@ -25,6 +25,9 @@
 #include "fbuf.h"
 #include "prim.h"
 
+// Prebuilt JIT code for all packages in a library
+#define LIB_JIT_PACK "_NVC_LIB.pack"
+
 typedef struct {
    char *cover_file;
 } unit_meta_t;
@@ -96,6 +96,14 @@ typedef struct {
    unsigned      field_idx;
 } field_toggle_params_t;
 
+typedef struct _unit_registry {
+   hash_t        *map;
+   hset_t        *visited;
+   mir_context_t *mir;
+   hset_t        *last_value;
+   hset_t        *last_scanned;
+} unit_registry_t;
+
 static vcode_reg_t lower_expr(lower_unit_t *lu, tree_t expr, expr_ctx_t ctx);
 static void lower_stmt(lower_unit_t *lu, tree_t stmt, loop_stack_t *loops);
 static void lower_func_body(lower_unit_t *lu, object_t *obj);
@@ -141,6 +149,7 @@ static vcode_type_t lower_func_result_type(type_t result);
 static vcode_reg_t lower_context_for_mangled(lower_unit_t *lu,
                                              ident_t unit_name);
 static vcode_reg_t lower_context_for_call(lower_unit_t *lu, tree_t decl);
+static vcode_reg_t lower_trigger(lower_unit_t *lu, tree_t fcall, tree_t wait);
 static void lower_driver_field_cb(lower_unit_t *lu, tree_t field,
                                   vcode_reg_t ptr, vcode_reg_t unused,
                                   vcode_reg_t locus, void *__ctx);
@@ -5658,6 +5667,63 @@ static vcode_reg_t lower_call_now(void)
    return emit_fcall(func, rtype, VCODE_INVALID_STAMP, args, ARRAY_LEN(args));
 }
 
+static vcode_reg_t lower_wait_guard(lower_unit_t *lu, tree_t wait,
+                                    tree_t value)
+{
+   // Find a side-effect free necessary condition for the process to
+   // resume which the kernel can evaluate without running the process
+   if (tree_kind(value) != T_FCALL)
+      return VCODE_INVALID_REG;
+
+   vcode_reg_t trigger_reg = lower_trigger(lu, value, wait);
+   if (trigger_reg != VCODE_INVALID_REG)
+      return trigger_reg;
+
+   tree_t decl = tree_ref(value);
+   switch (tree_subkind(decl)) {
+   case S_SCALAR_AND:
+      {
+         // Either operand is a necessary condition by itself
+         tree_t left = tree_value(tree_param(value, 0));
+         trigger_reg = lower_wait_guard(lu, wait, left);
+         if (trigger_reg != VCODE_INVALID_REG)
+            return trigger_reg;
+
+         tree_t right = tree_value(tree_param(value, 1));
+         return lower_wait_guard(lu, wait, right);
+      }
+   case S_SCALAR_OR:
+      {
+         tree_t left = tree_value(tree_param(value, 0));
+         tree_t right = tree_value(tree_param(value, 1));
+
+         vcode_reg_t left_reg = lower_wait_guard(lu, wait, left);
+         if (left_reg == VCODE_INVALID_REG)
+            return VCODE_INVALID_REG;
+
+         vcode_reg_t right_reg = lower_wait_guard(lu, wait, right);
+         if (right_reg == VCODE_INVALID_REG)
+            return VCODE_INVALID_REG;
+
+         return emit_or_trigger(left_reg, right_reg);
+      }
+   default:
+      return VCODE_INVALID_REG;
+   }
+}
+
+static bool can_use_wait_guard(lower_unit_t *lu, tree_t wait)
+{
+   if (!tree_has_value(wait) || tree_has_delay(wait))
+      return false;   // Timeout must always resume the process
+   else if (vcode_unit_kind(lu->vunit) != VCODE_UNIT_PROCESS)
+      return false;
+   else if (cover_enabled(lu->cover, COVER_MASK_BRANCH | COVER_MASK_EXPRESSION))
+      return false;   // Would have incorrect expression coverage
+   else
+      return true;
+}
+
 static void lower_wait(lower_unit_t *lu, tree_t wait)
 {
    const bool is_static = !!(tree_flags(wait) & TREE_F_STATIC_WAIT);
@@ -5696,6 +5762,16 @@ static void lower_wait(lower_unit_t *lu, tree_t wait)
       emit_store(abs_reg, remain);
    }
 
+   // The condition of a wait until statement is often false when the
+   // process wakes up so try to evaluate it in the kernel first
+   const bool guard = !is_static && can_use_wait_guard(lu, wait);
+
+   if (guard) {
+      vcode_reg_t trigger_reg = lower_wait_guard(lu, wait, tree_value(wait));
+      if (trigger_reg != VCODE_INVALID_REG)
+         emit_add_trigger(trigger_reg);
+   }
+
    vcode_block_t resume = emit_block();
    emit_wait(resume);
 
@@ -5736,6 +5812,13 @@ static void lower_wait(lower_unit_t *lu, tree_t wait)
       if (timeout_reg != VCODE_INVALID_REG)
          emit_sched_process(timeout_reg);
 
+      if (guard) {
+         vcode_reg_t trigger_reg =
+            lower_wait_guard(lu, wait, tree_value(wait));
+         if (trigger_reg != VCODE_INVALID_REG)
+            emit_add_trigger(trigger_reg);
+      }
+
       emit_wait(resume);
 
       vcode_select_block(done_bb);
@@ -8102,6 +8185,116 @@ static void lower_sub_signals(lower_unit_t *lu, type_t type, type_t var_type,
       fatal_trace("unhandled type %s in lower_sub_signals", type_pp(type));
 }
 
+static void lower_mark_last_value(hset_t *set, tree_t name)
+{
+   tree_t ref = name_to_ref(name);
+   while (ref != NULL && tree_has_ref(ref)) {
+      tree_t decl = tree_ref(ref);
+      if (tree_kind(decl) != T_ALIAS) {
+         hset_insert(set, decl);
+         break;
+      }
+
+      ref = name_to_ref(tree_value(decl));
+   }
+}
+
+static void lower_last_value_cb(tree_t t, void *ctx)
+{
+   hset_t *set = ctx;
+
+   switch (tree_kind(t)) {
+   case T_ATTR_REF:
+      if (tree_subkind(t) == ATTR_LAST_VALUE)
+         lower_mark_last_value(set, tree_name(t));
+      break;
+   case T_FCALL:
+   case T_PCALL:
+   case T_PROT_FCALL:
+   case T_PROT_PCALL:
+      {
+         // The callee may read 'LAST_VALUE of a signal parameter
+         tree_t decl = tree_has_ref(t) ? tree_ref(t) : NULL;
+         if (decl != NULL && !is_subprogram(decl))
+            decl = NULL;
+
+         const int nparams = tree_params(t);
+         for (int i = 0; i < nparams; i++) {
+            tree_t p = tree_param(t, i), port = NULL;
+            if (decl == NULL)
+               ;
+            else if (tree_subkind(p) == P_POS) {
+               if (tree_pos(p) < tree_ports(decl))
+                  port = tree_port(decl, tree_pos(p));
+            }
+            else {
+               tree_t ref = name_to_ref(tree_name(p));
+               if (ref != NULL && tree_has_ref(ref))
+                  port = tree_ref(ref);
+            }
+
+            if (port == NULL || class_of(port) == C_SIGNAL)
+               lower_mark_last_value(set, tree_value(p));
+         }
+      }
+      break;
+   case T_INSTANCE:
+   case T_BLOCK:
+      {
+         // Ports may be collapsed with the actual signal
+         const int nparams = tree_params(t);
+         for (int i = 0; i < nparams; i++)
+            lower_mark_last_value(set, tree_value(tree_param(t, i)));
+      }
+      break;
+   default:
+      break;
+   }
+}
+
+static void lower_scan_last_value(unit_registry_t *ur, tree_t t)
+{
+   // Instances cloned from the same block share their declarations and
+   // statements so each of these is only visited once
+   if (hset_contains(ur->last_scanned, t))
+      return;
+
+   hset_insert(ur->last_scanned, t);
+   tree_visit(t, lower_last_value_cb, ur->last_value);
+}
+
+static sig_flags_t lower_last_value_flag(lower_unit_t *lu, tree_t decl)
+{
+   // Storage for the last value of a signal is only allocated when
+   // 'LAST_VALUE may be read in the containing block
+   if (vcode_unit_kind(lu->vunit) != VCODE_UNIT_INSTANCE)
+      return SIG_F_LAST_VALUE;
+   else if (cover_enabled(lu->cover, COVER_MASK_TOGGLE))
+      return SIG_F_LAST_VALUE;   // Toggle callbacks compare with last value
+
+   unit_registry_t *ur = lu->registry;
+   if (ur->last_value == NULL) {
+      ur->last_value   = hset_new(128);
+      ur->last_scanned = hset_new(128);
+   }
+
+   if (!lu->last_value_scanned) {
+      tree_t b = lu->container;
+
+      const int ndecls = tree_decls(b);
+      for (int i = 0; i < ndecls; i++)
+         lower_scan_last_value(ur, tree_decl(b, i));
+
+      const int nstmts = tree_stmts(b);
+      for (int i = 0; i < nstmts; i++)
+         lower_scan_last_value(ur, tree_stmt(b, i));
+
+      lu->last_value_scanned = true;
+   }
+
+   return hset_contains(ur->last_value, decl) ? SIG_F_LAST_VALUE : 0;
+}
+
 static void lower_signal_decl(lower_unit_t *lu, tree_t decl)
 {
    type_t type = tree_type(decl);
@@ -8129,7 +8322,7 @@ static void lower_signal_decl(lower_unit_t *lu, tree_t decl)
    if (is_anonymous_subtype(type) && type_has_resolution(type))
       lower_resolution_var(lu, decl, type);
 
-   sig_flags_t flags = 0;
+   sig_flags_t flags = lower_last_value_flag(lu, decl);
    if (tree_flags(decl) & TREE_F_REGISTER)
       flags |= SIG_F_REGISTER;
 
@@ -8353,7 +8546,8 @@ static void lower_implicit_decl(lower_unit_t *parent, tree_t decl)
 
          lower_sub_signals(parent, type, type, type, decl, NULL, var,
                            VCODE_INVALID_REG, init_reg, VCODE_INVALID_REG,
-                           VCODE_INVALID_REG, 0, VCODE_INVALID_REG);
+                           VCODE_INVALID_REG, SIG_F_LAST_VALUE,
+                           VCODE_INVALID_REG);
 
          object_t *obj = tree_to_object(decl);
          ident_t name = ident_prefix(parent->name, tree_ident(decl), '.');
@@ -10372,7 +10566,7 @@ static bool can_use_transfer_signal(tree_t proc, driver_set_t *ds)
    return true;
 }
 
-static vcode_reg_t lower_trigger(lower_unit_t *lu, tree_t fcall, tree_t proc)
+static vcode_reg_t lower_trigger(lower_unit_t *lu, tree_t fcall, tree_t wait)
 {
    tree_t decl = tree_ref(fcall);
 
@@ -10398,10 +10592,7 @@ static vcode_reg_t lower_trigger(lower_unit_t *lu, tree_t fcall, tree_t proc)
    else if (kind == S_SCALAR_AND) {
       // Testing x'event is redundant if the process is only
       // sensitive to x
-      tree_t w = tree_stmt(proc, 1);
-      assert(tree_kind(w) == T_WAIT);
-
-      if (tree_triggers(w) != 1)
+      if (tree_triggers(wait) != 1)
          return VCODE_INVALID_REG;
 
       tree_t p0 = tree_value(tree_param(fcall, 0));
@@ -10420,10 +10611,10 @@ static vcode_reg_t lower_trigger(lower_unit_t *lu, tree_t fcall, tree_t proc)
       else if (tree_kind(other) != T_FCALL)
          return VCODE_INVALID_REG;
 
-      if (!same_tree(tree_name(aref), tree_trigger(w, 0)))
+      if (!same_tree(tree_name(aref), tree_trigger(wait, 0)))
          return VCODE_INVALID_REG;
 
-      return lower_trigger(lu, other, proc);
+      return lower_trigger(lu, other, wait);
    }
    else if (is_open_coded_builtin(kind))
       return VCODE_INVALID_REG;
@@ -10492,7 +10683,7 @@ static vcode_reg_t lower_process_trigger(lower_unit_t *lu, tree_t proc)
       if (tree_kind(value) != T_FCALL)
          return VCODE_INVALID_REG;
 
-      branches[i] = lower_trigger(lu, value, proc);
+      branches[i] = lower_trigger(lu, value, tree_stmt(proc, 1));
    }
 
    if (nconds == 1)
@@ -11506,7 +11697,7 @@ static void lower_port_signal(lower_unit_t *lu, tree_t port,
       init_reg = lower_rvalue(lu, value);
    }
 
-   sig_flags_t flags = 0;
+   sig_flags_t flags = lower_last_value_flag(lu, port);
    if (tree_flags(port) & TREE_F_REGISTER)
       flags |= SIG_F_REGISTER;
 
@@ -12521,6 +12712,7 @@ void lower_unit_free(lower_unit_t *lu)
 
    hash_free(lu->objects);
    ACLEAR(lu->free_temps);
+
    free(lu);
 }
 
@@ -12540,12 +12732,6 @@ typedef enum {
 typedef void (*dep_visit_fn_t)(vcode_unit_t, void *);
 typedef bool (*dep_filter_fn_t)(ident_t, void *);
 
-typedef struct _unit_registry {
-   hash_t        *map;
-   hset_t        *visited;
-   mir_context_t *mir;
-} unit_registry_t;
-
 typedef struct {
    lower_unit_t *parent;
    emit_fn_t     emit_fn;
@@ -12601,6 +12787,11 @@ void unit_registry_free(unit_registry_t *ur)
       }
    }
 
+   if (ur->last_value != NULL) {
+      hset_free(ur->last_value);
+      hset_free(ur->last_scanned);
+   }
+
    hash_free(ur->map);
    free(ur);
 }
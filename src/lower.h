@@ -48,6 +48,7 @@ typedef struct _lower_unit {
    cover_data_t    *cover;
    cover_scope_t   *cscope;
    bool             finished;
+   bool             last_value_scanned;
    lower_mode_t     mode;
    unsigned         deferred;
 } lower_unit_t;
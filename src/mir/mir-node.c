@@ -310,9 +310,31 @@ static node_data_t *mir_alloc_node(mir_unit_t *mu)
       bd->nodes[bd->num_nodes++] = mu->num_nodes;
       n = &(mu->nodes[mu->num_nodes++]);
    }
-   else {
+   else if (mu->nodes[bd->nodes[mu->cursor.pos]].op == _MIR_DELETED_OP)
       n = &(mu->nodes[bd->nodes[mu->cursor.pos]]);
-      assert(n->op == _MIR_DELETED_OP);
+   else {
+      // Insert new node before the cursor
+      if (bd->num_nodes == bd->max_nodes) {
+         bd->max_nodes = MAX(4, bd->num_nodes * 2);
+         bd->nodes = xrealloc_array(bd->nodes, bd->max_nodes,
+                                    sizeof(node_id_t));
+      }
+
+      if (mu->num_nodes == mu->max_nodes) {
+         mu->max_nodes = MAX(8, mu->num_nodes * 2);
+         mu->nodes = xrealloc_array(mu->nodes, mu->max_nodes,
+                                    sizeof(node_data_t));
+      }
+
+      const unsigned pos = mu->cursor.pos++;
+      memmove(bd->nodes + pos + 1, bd->nodes + pos,
+              (bd->num_nodes++ - pos) * sizeof(node_id_t));
+
+      if (bd->gap_pos >= (int)pos)
+         bd->gap_pos++;
+
+      bd->nodes[pos] = mu->num_nodes;
+      n = &(mu->nodes[mu->num_nodes++]);
    }
 
    return n;
@@ -17,6 +17,8 @@
 
 #include "util.h"
 #include "array.h"
+#include "cov/cov-api.h"
+#include "hash.h"
 #include "ident.h"
 #include "mask.h"
 #include "mir/mir-node.h"
@@ -1019,6 +1021,198 @@ static void mir_do_ra(mir_unit_t *mu, mir_optim_t *opt)
    opt->ra = NULL;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Coverage counter placement
+
+static bool cov_is_counter(const node_data_t *n)
+{
+   return n->op == MIR_OP_COVER_STMT || n->op == MIR_OP_COVER_BRANCH;
+}
+
+static bool cov_falls_through(mir_op_t op)
+{
+   // Operations which cannot raise an error or suspend the process:
+   // a counter after any number of these executes exactly as often as
+   // an earlier counter in the same block
+   switch (op) {
+   case MIR_OP_COMMENT:
+   case MIR_OP_CONST:
+   case MIR_OP_CONST_REAL:
+   case MIR_OP_CONST_ARRAY:
+   case MIR_OP_CONST_REP:
+   case MIR_OP_CONST_RECORD:
+   case MIR_OP_CONST_VEC:
+   case MIR_OP_ADD:
+   case MIR_OP_SUB:
+   case MIR_OP_MUL:
+   case MIR_OP_AND:
+   case MIR_OP_OR:
+   case MIR_OP_XOR:
+   case MIR_OP_NOT:
+   case MIR_OP_NEG:
+   case MIR_OP_ABS:
+   case MIR_OP_CMP:
+   case MIR_OP_SELECT:
+   case MIR_OP_CAST:
+   case MIR_OP_LOAD:
+   case MIR_OP_STORE:
+   case MIR_OP_COPY:
+   case MIR_OP_SET:
+   case MIR_OP_ALLOC:
+   case MIR_OP_ARRAY_REF:
+   case MIR_OP_RECORD_REF:
+   case MIR_OP_TABLE_REF:
+   case MIR_OP_ADDRESS_OF:
+   case MIR_OP_VAR_UPREF:
+   case MIR_OP_CONTEXT_UPREF:
+   case MIR_OP_WRAP:
+   case MIR_OP_UNWRAP:
+   case MIR_OP_UARRAY_LEN:
+   case MIR_OP_UARRAY_LEFT:
+   case MIR_OP_UARRAY_RIGHT:
+   case MIR_OP_UARRAY_DIR:
+   case MIR_OP_RANGE_LENGTH:
+   case MIR_OP_RANGE_NULL:
+   case MIR_OP_LOCUS:
+   case MIR_OP_CONSUME:
+   case MIR_OP_PACK:
+   case MIR_OP_UNPACK:
+   case MIR_OP_BINARY:
+   case MIR_OP_UNARY:
+   case MIR_OP_INSERT:
+   case MIR_OP_TEST:
+   case MIR_OP_EXTRACT:
+   case MIR_OP_EVENT:
+   case MIR_OP_ACTIVE:
+   case MIR_OP_SCHED_WAVEFORM:
+   case MIR_OP_COVER_STMT:
+   case MIR_OP_COVER_BRANCH:
+   case MIR_OP_COVER_EXPR:
+      return true;
+   default:
+      return false;
+   }
+}
+
+static bool cov_get_source(mir_unit_t *mu, const node_data_t *n,
+                           unsigned *hops, unsigned *nth)
+{
+   // Processes load the counters pointer from the #counters variable
+   // in the enclosing instance
+   const mir_value_t *args = mir_get_args(mu, n);
+   if (mir_get_op(mu, args[0]) != MIR_OP_LOAD)
+      return false;
+
+   mir_value_t ptr = mir_get_args(mu, mir_node_data(mu, args[0]))[0];
+   if (mir_get_op(mu, ptr) != MIR_OP_VAR_UPREF)
+      return false;
+
+   const mir_value_t *uargs = mir_get_args(mu, mir_node_data(mu, ptr));
+   assert(uargs[0].tag == MIR_TAG_ENUM);
+   assert(uargs[2].tag == MIR_TAG_ENUM);
+
+   *hops = uargs[0].id;
+   *nth = uargs[2].id;
+   return true;
+}
+
+static void mir_do_cover(mir_unit_t *mu)
+{
+   // Only the first statement or branch counter in each run through a
+   // basic block is incremented and the others store a reference to it
+   // which is resolved when the coverage database is written out.  The
+   // references are written once in the reset block of the process.
+   if (mu->kind != MIR_UNIT_PROCESS)
+      return;
+
+   unsigned hops = 0, nth = 0, ncounters = 0;
+   ihash_t *uses = NULL;
+   A(unsigned) aliases = AINIT;
+
+   for (int i = 0; i < mu->blocks.count; i++) {
+      const block_data_t *bd = &(mu->blocks.items[i]);
+      for (int j = 0; j < bd->num_nodes; j++) {
+         const node_data_t *n = &(mu->nodes[bd->nodes[j]]);
+         if (!cov_is_counter(n))
+            continue;
+
+         unsigned h, v;
+         if (!cov_get_source(mu, n, &h, &v))
+            goto out;
+         else if (ncounters++ == 0) {
+            hops = h;
+            nth = v;
+            uses = ihash_new(64);
+         }
+         else if (h != hops || v != nth)
+            goto out;
+
+         // A tag may be emitted more than once, e.g. if the lowering
+         // duplicates code, in which case it cannot be merged
+         const unsigned tag = mir_get_args(mu, n)[1].id;
+         const uintptr_t count = (uintptr_t)ihash_get(uses, tag);
+         ihash_put(uses, tag, (void *)(count + 1));
+      }
+   }
+
+   if (ncounters < 2)
+      goto out;
+
+   for (int i = 0; i < mu->blocks.count; i++) {
+      mir_block_t this = { .tag = MIR_TAG_BLOCK, .id = i };
+      const block_data_t *bd = mir_block_data(mu, this);
+
+      unsigned leader = UINT_MAX;
+      for (int j = 0; j < bd->num_nodes; j++) {
+         const node_data_t *n = &(mu->nodes[bd->nodes[j]]);
+         if (cov_is_counter(n)) {
+            const unsigned tag = mir_get_args(mu, n)[1].id;
+            if ((uintptr_t)ihash_get(uses, tag) != 1)
+               continue;
+            else if (leader == UINT_MAX)
+               leader = tag;
+            else {
+               APUSH(aliases, tag);
+               APUSH(aliases, leader);
+
+               mir_set_cursor(mu, this, j);
+               mir_delete(mu);
+            }
+         }
+         else if (!cov_falls_through(n->op))
+            leader = UINT_MAX;
+      }
+   }
+
+   if (aliases.count == 0)
+      goto out;
+
+   mir_compact(mu);
+
+   mir_set_cursor(mu, mir_get_block(mu, 0), 0);
+
+   mir_type_t t_int32 = mir_int_type(mu, INT32_MIN, INT32_MAX);
+   mir_type_t t_offset = mir_offset_type(mu);
+
+   mir_value_t upref = mir_build_var_upref(mu, hops, nth);
+   mir_value_t counters = mir_build_load(mu, upref);
+
+   for (int i = 0; i < aliases.count; i += 2) {
+      mir_value_t offset = mir_const(mu, t_offset, aliases.items[i]);
+      mir_value_t ptr = mir_build_array_ref(mu, counters, offset);
+      const int32_t ref = COV_COUNTER_ALIAS(aliases.items[i + 1]);
+      mir_build_store(mu, ptr, mir_const(mu, t_int32, ref));
+   }
+
+   mir_set_cursor(mu, MIR_NULL_BLOCK, MIR_APPEND);
+
+ out:
+   if (uses != NULL)
+      ihash_free(uses);
+
+   ACLEAR(aliases);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Debugging
 
@@ -1151,6 +1345,9 @@ void mir_optimise(mir_unit_t *mu, mir_pass_t passes)
 {
    mir_optim_t opt = {};
 
+   if (passes & MIR_PASS_COV)
+      mir_do_cover(mu);
+
    const mir_pass_t need_dom = MIR_PASS_GVN;
    const mir_pass_t need_liveness = MIR_PASS_DCE | MIR_PASS_RA;
    const mir_pass_t need_cfg = need_dom | need_liveness | MIR_PASS_CFG;
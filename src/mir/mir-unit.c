@@ -413,21 +413,22 @@ ident_t mir_get_linkage(mir_unit_t *mu, unsigned nth)
 }
 
 #ifdef DEBUG
-void mir_compare_layout(mir_unit_t *a, mir_unit_t *b)
+void mir_compare_layout(mir_unit_t *mu, mir_shape_t *shape)
 {
-   if (a->vars.count != b->vars.count)
+   // Compare against the shape as the other unit may have been freed
+   if (mu->vars.count != shape->num_slots)
       goto differ;
 
-   for (int i = 0; i < a->vars.count; i++) {
-      if (!mir_equals(a->vars.items[i].type, b->vars.items[i].type))
+   for (int i = 0; i < mu->vars.count; i++) {
+      if (!mir_equals(mu->vars.items[i].type, shape->slots[i].type))
          goto differ;
    }
 
    return;
 
  differ:
-   mir_dump(a);
-   mir_dump(b);
-   fatal_trace("%s and %s have differing layout", istr(a->name), istr(b->name));
+   mir_dump(mu);
+   fatal_trace("%s and %s have differing layout", istr(mu->name),
+               istr(shape->name));
 }
 #endif
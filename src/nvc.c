@@ -85,6 +85,7 @@ const char version_string[] =
 
 static int process_command(int argc, char **argv, cmd_state_t *state);
 static int parse_int(const char *str);
+static size_t parse_size(const char *str);
 static jit_t *get_jit(cmd_state_t *state);
 
 static ident_t to_unit_name(const char *str)
@@ -106,7 +107,7 @@ static int scan_cmd(int start, int argc, char **argv)
       "-a", "-e", "-r", "-c", "--dump", "--make", "--syntax", "--list",
       "--init", "--install", "--print-deps", "--do", "-i",
       "--cover-export", "--preprocess", "--gui", "--cover-merge",
-      "--cover-report",
+      "--cover-report", "--jit-pack",
    };
 
    for (int i = start; i < argc; i++) {
@@ -425,7 +426,8 @@ static void parse_cover_options(const char *str, cover_mask_t *mask,
       { "count-from-to-z",       COVER_MASK_TOGGLE_COUNT_FROM_TO_Z      },
       { "include-mems",          COVER_MASK_TOGGLE_INCLUDE_MEMS         },
       { "exclude-unreachable",   COVER_MASK_EXCLUDE_UNREACHABLE         },
-      { "fsm-no-default-enums",  COVER_MASK_FSM_NO_DEFAULT_ENUMS        }
+      { "fsm-no-default-enums",  COVER_MASK_FSM_NO_DEFAULT_ENUMS        },
+      { "stop-at-threshold",     COVER_MASK_STOP_AT_THRESHOLD           }
    };
 
    for (const char *start = str; ; str++) {
@@ -498,10 +500,12 @@ static int elaborate(int argc, char **argv, cmd_state_t *state)
       { "no-collapse",     no_argument,       0, 'C' },
       { "stats",           no_argument,       0, 'S' },
       { "trace",           no_argument,       0, 't' },
+      { "memory-budget",   required_argument, 0, 'M' },
       { 0, 0, 0, 0 }
    };
 
    bool no_save = false;
+   size_t budget = 0;
    unit_meta_t meta = {};
    cover_mask_t cover_mask = 0;
    const char *cover_spec_file = NULL, *sdf_args = NULL;
@@ -559,6 +563,9 @@ static int elaborate(int argc, char **argv, cmd_state_t *state)
       case 'S':
          opt_set_int(OPT_ELAB_STATS, 1);
          break;
+      case 'M':
+         budget = parse_size(optarg);
+         break;
       case 0:
          // Set a flag
          break;
@@ -630,11 +637,23 @@ static int elaborate(int argc, char **argv, cmd_state_t *state)
 
    vhpi_run_callbacks(vhpiCbStartOfElaboration);
 
+   // With a memory budget units are compiled and their MIR released
+   // while the design is elaborated rather than all at once at the end
+   cgen_stream_t *stream = NULL;
+   if (budget > 0 && !no_save) {
+      ident_t ename = ident_prefix(state->top_level, well_known(W_ELAB), '.');
+      stream = cgen_stream_new(ename, state->registry, state->mir,
+                               state->jit, budget);
+   }
+
    tree_t top = elab(obj, state->jit, state->registry, state->mir,
-                     state->cover, NULL, state->model);
+                     state->cover, NULL, state->model, stream);
 
-   if (top == NULL)
+   if (top == NULL) {
+      if (stream != NULL)
+         cgen_stream_free(stream);
       return EXIT_FAILURE;
+   }
 
    lib_put_meta(state->work, top, &meta);
 
@@ -642,22 +661,28 @@ static int elaborate(int argc, char **argv, cmd_state_t *state)
 
    vhpi_run_callbacks(vhpiCbEndOfElaboration);
 
-   if (error_count() > 0)
+   if (error_count() > 0) {
+      if (stream != NULL)
+         cgen_stream_free(stream);
       return EXIT_FAILURE;
+   }
 
    const char *elab_name = istr(tree_ident(top));
    char *pack_name LOCAL = xasprintf("_%s.pack", elab_name);
 
    // Delete any existing generated code to avoid accidentally loading
    // the wrong version later
-   lib_delete(state->work, pack_name);
+   if (stream == NULL)
+      lib_delete(state->work, pack_name);
 
    if (!no_save) {
       lib_save(state->work);
       progress("saving library");
    }
 
-   if (!no_save)
+   if (stream != NULL)
+      cgen_stream_finish(stream, top);
+   else if (!no_save)
       cgen(top, state->registry, state->mir, state->jit);
 
    if (state->cover != NULL) {
@@ -1288,6 +1313,47 @@ static int init_cmd(int argc, char **argv, cmd_state_t *state)
    return argc > 1 ? process_command(argc, argv, state) : EXIT_SUCCESS;
 }
 
+static int jit_pack_cmd(int argc, char **argv, cmd_state_t *state)
+{
+   static struct option long_options[] = {
+      { 0, 0, 0, 0 }
+   };
+
+   const int next_cmd = scan_cmd(2, argc, argv);
+   int c, index = 0;
+   const char *spec = ":";
+   while ((c = getopt_long(next_cmd, argv, spec, long_options, &index)) != -1) {
+      switch (c) {
+      case 0:
+         // Set a flag
+         break;
+      case '?':
+         bad_option("jit-pack", argv);
+      case ':':
+         missing_argument("jit-pack", argv);
+      }
+   }
+
+   if (optind != next_cmd)
+      fatal("$bold$--jit-pack$$ command takes no positional arguments");
+
+   if (state->mir == NULL)
+      state->mir = mir_context_new();
+
+   if (state->registry == NULL)
+      state->registry = unit_registry_new(state->mir);
+
+   if (state->jit == NULL)
+      state->jit = get_jit(state);
+
+   cgen_library(state->work, state->registry, state->mir, state->jit);
+
+   argc -= next_cmd - 1;
+   argv += next_cmd - 1;
+
+   return argc > 1 ? process_command(argc, argv, state) : EXIT_SUCCESS;
+}
+
 static void list_packages(void)
 {
    LOCAL_TEXT_BUF tb = tb_new();
@@ -2222,6 +2288,7 @@ static void usage(void)
 #endif
            { "--init", "Initialise work library directory" },
            { "--install PKG", "Install third-party packages" },
+           { "--jit-pack", "Generate JIT code for all packages in library" },
            { "--list", "Print all units in the library" },
            { "--preprocess FILE...",
              "Expand FILEs with Verilog preprocessor" },
@@ -2512,6 +2579,7 @@ static int process_command(int argc, char **argv, cmd_state_t *state)
       { "cover-merge",  no_argument, 0, 'M' },
       { "cover-report", no_argument, 0, 'p' },
       { "preprocess",   no_argument, 0, 'R' },
+      { "jit-pack",     no_argument, 0, 'J' },
 #ifdef ENABLE_GUI
       { "gui",          no_argument, 0, 'g' },
 #endif
@@ -2558,6 +2626,8 @@ static int process_command(int argc, char **argv, cmd_state_t *state)
       return cover_report_cmd(argc, argv, state);
    case 'R':
       return preprocess_cmd(argc, argv, state);
+   case 'J':
+      return jit_pack_cmd(argc, argv, state);
 #ifdef ENABLE_GUI
    case 'g':
       return gui_cmd(argc, argv, state);
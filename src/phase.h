@@ -40,7 +40,8 @@ void bounds_check(tree_t top);
 
 // Elaborate a top level design unit
 tree_t elab(object_t *top, jit_t *jit, unit_registry_t *ur, mir_context_t *mc,
-            cover_data_t *cover, sdf_file_t *sdf, rt_model_t *m);
+            cover_data_t *cover, sdf_file_t *sdf, rt_model_t *m,
+            cgen_stream_t *cs);
 
 // Set the value of a top-level generic
 void elab_set_generic(const char *name, const char *value);
@@ -48,6 +49,18 @@ void elab_set_generic(const char *name, const char *value);
 // Serialise JIT code to disk
 void cgen(tree_t top, unit_registry_t *ur, mir_context_t *mc, jit_t *jit);
 
+// Compile units and release their MIR while the design is being
+// elaborated then serialise the JIT code to disk at the end
+cgen_stream_t *cgen_stream_new(ident_t name, unit_registry_t *ur,
+                               mir_context_t *mc, jit_t *jit, size_t budget);
+void cgen_stream_block(cgen_stream_t *cs, tree_t block);
+void cgen_stream_finish(cgen_stream_t *cs, tree_t top);
+void cgen_stream_free(cgen_stream_t *cs);
+
+// Serialise JIT code for all packages in a library
+void cgen_library(lib_t lib, unit_registry_t *ur, mir_context_t *mc,
+                  jit_t *jit);
+
 // Dump out a VHDL representation of the given unit
 void dump(tree_t top);
 
@@ -68,6 +68,8 @@ typedef struct _mir_context mir_context_t;
 typedef struct _mir_unit mir_unit_t;
 typedef struct _mir_shape mir_shape_t;
 typedef struct _vlog_symtab vlog_symtab_t;
+typedef struct _jit_pack_stream jit_pack_stream_t;
+typedef struct _cgen_stream cgen_stream_t;
 
 typedef struct _rt_model      rt_model_t;
 typedef struct _rt_watch      rt_watch_t;
@@ -82,6 +84,7 @@ typedef struct _rt_resolution rt_resolution_t;
 typedef struct _rt_trigger    rt_trigger_t;
 typedef struct _rt_prop       rt_prop_t;
 typedef struct _rt_conv_func  rt_conv_func_t;
+typedef struct _rt_random     rt_random_t;
 
 typedef struct waveform  waveform_t;
 typedef struct sens_list sens_list_t;
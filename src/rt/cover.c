@@ -47,6 +47,13 @@ enum std_ulogic {
 
 typedef void (*toggle_check_fn_t)(uint8_t, uint8_t, int32_t *, int32_t *);
 
+// With COVER_MASK_STOP_AT_THRESHOLD the watch is removed once every
+// counter it updates has reached the threshold
+typedef struct {
+   unsigned remaining;
+   int32_t  threshold;
+} cover_retire_t;
+
 __attribute__((always_inline))
 static inline void increment_counter(int32_t *ptr)
 {
@@ -126,8 +133,9 @@ static inline void cover_toggle_check_0_1_u_z(uint8_t old, uint8_t new,
 }
 
 __attribute__((always_inline))
-static inline void cover_toggle_generic(rt_signal_t *s, int32_t *counters,
-                                        toggle_check_fn_t fn)
+static inline bool cover_toggle_generic(rt_signal_t *s, int32_t *counters,
+                                        toggle_check_fn_t fn,
+                                        cover_retire_t *retire)
 {
    const void *cur = signal_value(s);
    const void *last = signal_last_value(s);
@@ -155,36 +163,82 @@ static inline void cover_toggle_generic(rt_signal_t *s, int32_t *counters,
       for (int j = low; j < high; j++) {
          uint8_t new = ((const uint8_t *)cur)[j];
          uint8_t old = ((const uint8_t *)last)[j];
-         if (new != old)
+         if (new == old)
+            ;
+         else if (retire != NULL) {
+            const int32_t pre_01 = *toggle_01, pre_10 = *toggle_10;
+            (*fn)(old, new, toggle_01, toggle_10);
+
+            if (pre_01 < retire->threshold && *toggle_01 >= retire->threshold)
+               retire->remaining--;
+            if (pre_10 < retire->threshold && *toggle_10 >= retire->threshold)
+               retire->remaining--;
+         }
+         else
             (*fn)(old, new, toggle_01, toggle_10);
          toggle_01 += 2;
          toggle_10 += 2;
       }
    }
+
+   return retire != NULL && retire->remaining == 0;
 }
 
 static void cover_toggle_cb_0_1(uint64_t now, rt_signal_t *s, rt_watch_t *w,
                                 void *user)
 {
-   cover_toggle_generic(s, user, cover_toggle_check_0_1);
+   cover_toggle_generic(s, user, cover_toggle_check_0_1, NULL);
 }
 
 static void cover_toggle_cb_0_1_u(uint64_t now, rt_signal_t *s, rt_watch_t *w,
                                   void *user)
 {
-   cover_toggle_generic(s, user, cover_toggle_check_0_1_u);
+   cover_toggle_generic(s, user, cover_toggle_check_0_1_u, NULL);
 }
 
 static void cover_toggle_cb_0_1_z(uint64_t now, rt_signal_t *s, rt_watch_t *w,
                                   void *user)
 {
-   cover_toggle_generic(s, user, cover_toggle_check_0_1_z);
+   cover_toggle_generic(s, user, cover_toggle_check_0_1_z, NULL);
 }
 
 static void cover_toggle_cb_0_1_u_z(uint64_t now, rt_signal_t *s, rt_watch_t *w,
                                     void *user)
 {
-   cover_toggle_generic(s, user, cover_toggle_check_0_1_u_z);
+   cover_toggle_generic(s, user, cover_toggle_check_0_1_u_z, NULL);
+}
+
+typedef struct {
+   cover_retire_t  retire;
+   int32_t        *counters;
+} toggle_retire_t;
+
+#define TOGGLE_RETIRE_CB(suffix)                                        \
+   static void cover_toggle_retire_cb_##suffix(uint64_t now,            \
+                                               rt_signal_t *s,          \
+                                               rt_watch_t *w,           \
+                                               void *user)              \
+   {                                                                    \
+      toggle_retire_t *tr = user;                                       \
+      if (cover_toggle_generic(s, tr->counters,                         \
+                               cover_toggle_check_##suffix,             \
+                               &(tr->retire)))                          \
+         watch_free(get_model(), w);                                    \
+   }
+
+TOGGLE_RETIRE_CB(0_1)
+TOGGLE_RETIRE_CB(0_1_u)
+TOGGLE_RETIRE_CB(0_1_z)
+TOGGLE_RETIRE_CB(0_1_u_z)
+
+static int32_t cover_get_threshold(cover_data_t *data, ident_t name,
+                                   int32_t tag)
+{
+   const cover_item_t *item = cover_get_item(data, name, tag);
+   if (item == NULL)
+      return 0;
+
+   return MAX(item->atleast, 1);
 }
 
 static bool is_constant_input(rt_signal_t *s)
@@ -245,19 +299,50 @@ void x_cover_setup_toggle_cb(sig_shared_t *ss, int32_t tag)
       return;
    }
 
-   sig_event_fn_t fn = &cover_toggle_cb_0_1;
+   const bool from_undef = !!(op_mask & COVER_MASK_TOGGLE_COUNT_FROM_UNDEFINED);
+   const bool to_z = !!(op_mask & COVER_MASK_TOGGLE_COUNT_FROM_TO_Z);
+
+   int32_t threshold = 0;
+   if (op_mask & COVER_MASK_STOP_AT_THRESHOLD)
+      threshold = cover_get_threshold(data, get_active_scope(m)->name, tag);
+
+   rt_watch_t *w;
+   if (threshold > 0) {
+      toggle_retire_t *tr = pool_malloc(data->pool, sizeof(toggle_retire_t));
+      tr->counters = counters + tag;
+      tr->retire.threshold = threshold;
+      tr->retire.remaining = 0;
+
+      for (int i = 0; i < 2 * s->shared.size; i++) {
+         if (tr->counters[i] < threshold)
+            tr->retire.remaining++;
+      }
 
-   if ((op_mask & COVER_MASK_TOGGLE_COUNT_FROM_UNDEFINED) &&
-       (op_mask & COVER_MASK_TOGGLE_COUNT_FROM_TO_Z))
-      fn = &cover_toggle_cb_0_1_u_z;
+      if (tr->retire.remaining == 0)
+         return;
 
-   else if (op_mask & COVER_MASK_TOGGLE_COUNT_FROM_UNDEFINED)
-      fn = &cover_toggle_cb_0_1_u;
+      sig_event_fn_t fn = &cover_toggle_retire_cb_0_1;
+      if (from_undef && to_z)
+         fn = &cover_toggle_retire_cb_0_1_u_z;
+      else if (from_undef)
+         fn = &cover_toggle_retire_cb_0_1_u;
+      else if (to_z)
+         fn = &cover_toggle_retire_cb_0_1_z;
 
-   else if (op_mask & COVER_MASK_TOGGLE_COUNT_FROM_TO_Z)
-      fn = &cover_toggle_cb_0_1_z;
+      w = watch_new(m, fn, tr, WATCH_EVENT, 1);
+   }
+   else {
+      sig_event_fn_t fn = &cover_toggle_cb_0_1;
+      if (from_undef && to_z)
+         fn = &cover_toggle_cb_0_1_u_z;
+      else if (from_undef)
+         fn = &cover_toggle_cb_0_1_u;
+      else if (to_z)
+         fn = &cover_toggle_cb_0_1_z;
+
+      w = watch_new(m, fn, counters + tag, WATCH_EVENT, 1);
+   }
 
-   rt_watch_t *w = watch_new(m, fn, counters + tag, WATCH_EVENT, 1);
    model_set_event_cb(m, s, w);
 }
 
@@ -267,17 +352,40 @@ void x_cover_setup_toggle_cb(sig_shared_t *ss, int32_t tag)
 
 #define READ_STATE(type) offset = *((type *)signal_value(s));
 
-static void cover_state_cb(uint64_t now, rt_signal_t *s, rt_watch_t *w,
-                           void *user)
+static inline int32_t cover_read_state(rt_signal_t *s)
 {
    // I-th enum literal is encoded in i-th tag from first tag, that corresponds
    // to enum value.
    int size = signal_size(s);
    int32_t offset = 0;
    FOR_ALL_SIZES(size, READ_STATE);
+   return offset;
+}
 
+static void cover_state_cb(uint64_t now, rt_signal_t *s, rt_watch_t *w,
+                           void *user)
+{
    int32_t *counters = user;
-   increment_counter(counters + offset);
+   increment_counter(counters + cover_read_state(s));
+}
+
+typedef struct {
+   cover_retire_t  retire;
+   int32_t        *counters;
+} state_retire_t;
+
+static void cover_state_retire_cb(uint64_t now, rt_signal_t *s, rt_watch_t *w,
+                                  void *user)
+{
+   state_retire_t *sr = user;
+   int32_t *ptr = sr->counters + cover_read_state(s);
+
+   const int32_t pre = *ptr;
+   increment_counter(ptr);
+
+   if (pre < sr->retire.threshold && *ptr >= sr->retire.threshold
+       && --(sr->retire.remaining) == 0)
+      watch_free(get_model(), w);
 }
 
 void x_cover_setup_state_cb(sig_shared_t *ss, int64_t low, int32_t tag)
@@ -297,8 +405,30 @@ void x_cover_setup_state_cb(sig_shared_t *ss, int64_t low, int32_t tag)
    // cause an event. First tag needs to be flagged as covered manually.
    *(counters + tag) = 1;
 
-   rt_watch_t *w = watch_new(m, cover_state_cb, counters + tag - low,
-                             WATCH_EVENT, 1);
+   const cover_item_t *item = NULL;
+   if (data->mask & COVER_MASK_STOP_AT_THRESHOLD)
+      item = cover_get_item(data, get_active_scope(m)->name, tag);
+
+   rt_watch_t *w;
+   if (item != NULL) {
+      state_retire_t *sr = pool_malloc(data->pool, sizeof(state_retire_t));
+      sr->counters = counters + tag - low;
+      sr->retire.threshold = MAX(item->atleast, 1);
+      sr->retire.remaining = 0;
+
+      for (int i = 0; i < item->consecutive; i++) {
+         if (counters[tag + i] < sr->retire.threshold)
+            sr->retire.remaining++;
+      }
+
+      if (sr->retire.remaining == 0)
+         return;
+
+      w = watch_new(m, cover_state_retire_cb, sr, WATCH_EVENT, 1);
+   }
+   else
+      w = watch_new(m, cover_state_cb, counters + tag - low, WATCH_EVENT, 1);
+
    model_set_event_cb(m, s, w);
 }
 
@@ -0,0 +1,240 @@
+//
+//  Copyright (C) 2025  Nick Gasson
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "util.h"
+#include "jit/jit-exits.h"
+#include "jit/jit.h"
+#include "printf.h"
+#include "rt/model.h"
+#include "rt/structs.h"
+#include "vlog/vlog-defs.h"
+#include "vlog/vlog-number.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void display_vec4(char radix, int size, bool issigned,
+                         const jit_scalar_t *args, text_buf_t *tb)
+{
+   if (size <= 64) {
+      const uint64_t mask = ~UINT64_C(0) >> (64 - size);
+      const uint64_t abits = args[0].integer & mask;
+      const uint64_t bbits = args[1].integer & mask;
+      vec4_format(radix, size, issigned, &abits, &bbits, tb);
+   }
+   else {
+      // Wide vectors are passed as pointers to arrays of words
+      const uint64_t *abits = args[0].pointer, *bbits = args[1].pointer;
+      if (bbits == NULL) {
+         uint64_t *zero LOCAL = xcalloc_array((size + 63) / 64,
+                                              sizeof(uint64_t));
+         vec4_format(radix, size, issigned, abits, zero, tb);
+      }
+      else
+         vec4_format(radix, size, issigned, abits, bbits, tb);
+   }
+}
+
+static void display_real(char radix, double value, text_buf_t *tb)
+{
+   if (radix == 'f')
+      tb_printf(tb, "%f", value);
+   else {
+      const uint64_t abits = llround(value), bbits = 0;
+      vec4_format(radix, 64, true, &abits, &bbits, tb);
+   }
+}
+
+static void display_time(char radix, text_buf_t *tb)
+{
+   const uint64_t abits = model_now(get_model(), NULL), bbits = 0;
+   vec4_format(radix, 64, false, &abits, &bbits, tb);
+}
+
+static const uint8_t *display_exec(const uint8_t *prog,
+                                   const jit_scalar_t *args, text_buf_t *tb)
+{
+   for (;;) {
+      switch (*prog++) {
+      case DISPLAY_END:
+         return prog;
+      case DISPLAY_TEXT:
+         {
+            const size_t len = *prog++;
+            tb_catn(tb, (const char *)prog, len);
+            prog += len;
+         }
+         break;
+      case DISPLAY_VEC4:
+         {
+            const char radix = prog[0];
+            const bool issigned = prog[1];
+            const int size = prog[2] | prog[3] << 8 | prog[4] << 16
+               | prog[5] << 24;
+
+            display_vec4(radix, size, issigned, args, tb);
+
+            prog += 6;
+            args += 2;
+         }
+         break;
+      case DISPLAY_REAL:
+         display_real(*prog++, args[0].real, tb);
+         args++;
+         break;
+      case DISPLAY_TIME:
+         display_time(*prog++, tb);
+         break;
+      default:
+         should_not_reach_here();
+      }
+   }
+}
+
+void x_display(const uint8_t *prog, const jit_scalar_t *args)
+{
+   static __thread text_buf_t *tb = NULL;
+   if (tb == NULL)
+      tb = tb_new();
+   else
+      tb_rewind(tb);
+
+   display_exec(prog, args, tb);
+
+   // Write the whole line with a single call
+   ostream_write(nvc_stdout(), tb_get(tb), tb_len(tb));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// $strobe
+
+typedef struct {
+   jit_t         *jit;
+   ffi_closure_t  closure;
+} strobe_t;
+
+static void strobe_cb(rt_model_t *m, void *user)
+{
+   strobe_t *s = user;
+
+   // The closure evaluates the arguments and prints them as $display
+   jit_scalar_t result;
+   if (!jit_try_call(s->jit, s->closure.handle, &result, s->closure.context))
+      model_stop(m);
+
+   free(s);
+}
+
+void x_strobe(const ffi_closure_t *closure)
+{
+   strobe_t *s = xcalloc(sizeof(strobe_t));
+   s->jit     = jit_for_thread();
+   s->closure = *closure;
+
+   // Printed once all other events in the current time step have run
+   model_set_phase_cb(get_model(), END_TIME_STEP, strobe_cb, s);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// $monitor
+
+typedef struct {
+   rt_watch_t    *watch;
+   jit_t         *jit;
+   ffi_closure_t  closure;
+   int64_t        printed;
+} monitor_t;
+
+static monitor_t *monitor = NULL;
+
+static void monitor_print(rt_model_t *m, monitor_t *mon)
+{
+   const int64_t now = model_now(m, NULL);
+   if (mon->printed == now)
+      return;   // At most once per time step
+
+   mon->printed = now;
+
+   // The closure evaluates the arguments again and prints them as
+   // $display
+   jit_scalar_t result;
+   if (!jit_try_call(mon->jit, mon->closure.handle, &result,
+                     mon->closure.context))
+      model_stop(m);
+}
+
+static void monitor_event_cb(uint64_t now, rt_signal_t *s, rt_watch_t *w,
+                             void *user)
+{
+   monitor_print(get_model(), user);
+}
+
+static void monitor_initial_cb(rt_model_t *m, void *user)
+{
+   if (monitor != NULL)
+      monitor_print(m, monitor);
+}
+
+static void monitor_free(rt_model_t *m, monitor_t *mon)
+{
+   watch_free(m, mon->watch);
+   free(mon);
+}
+
+static void monitor_end_cb(rt_model_t *m, void *user)
+{
+   if (monitor != NULL) {
+      monitor_free(m, monitor);
+      monitor = NULL;
+   }
+}
+
+void x_monitor(const ffi_closure_t *closure, sig_shared_t **signals,
+               int count)
+{
+   rt_model_t *m = get_model();
+
+   // Only one monitor can be active at a time
+   monitor_end_cb(m, NULL);
+
+   monitor_t *mon = xcalloc(sizeof(monitor_t));
+   mon->jit     = jit_for_thread();
+   mon->closure = *closure;
+   mon->printed = -1;
+   mon->watch   = watch_new(m, monitor_event_cb, mon, WATCH_POSTPONED,
+                            MAX(count, 1));
+
+   for (int i = 0; i < count; i++) {
+      rt_signal_t *s = container_of(signals[i], rt_signal_t, shared);
+
+      bool seen = false;
+      for (int j = 0; j < mon->watch->next_slot; j++)
+         seen |= (mon->watch->signals[j] == s);
+
+      if (!seen)
+         model_set_event_cb(m, s, mon->watch);
+   }
+
+   monitor = mon;
+
+   // The first line is printed at the end of the current time step
+   // even if none of the arguments change
+   model_set_phase_cb(m, END_TIME_STEP, monitor_initial_cb, NULL);
+   model_set_phase_cb(m, END_OF_SIMULATION, monitor_end_cb, NULL);
+}
@@ -17,6 +17,7 @@
 
 #include "util.h"
 #include "diag.h"
+#include "hash.h"
 #include "ident.h"
 #include "jit/jit.h"
 #include "jit/jit-exits.h"
@@ -31,7 +32,9 @@
 #include <stdio.h>
 #include <stdlib.h>
 
-static tree_t select_name(tree_t where, ident_t id)
+#define NAME_INDEX_MIN 16
+
+static tree_t search_region(tree_t where, ident_t id)
 {
    const int ndecls = tree_decls(where);
    for (int i = 0; i < ndecls; i++) {
@@ -49,7 +52,7 @@ static tree_t select_name(tree_t where, ident_t id)
 
    switch (tree_kind(where)) {
    case T_PACKAGE:
-      return select_name(body_of(where), id);
+      return search_region(body_of(where), id);
    case T_PACK_BODY:
       return NULL;
    default:
@@ -73,6 +76,60 @@ static tree_t select_name(tree_t where, ident_t id)
    return NULL;
 }
 
+static void index_name(hash_t *index, tree_t t)
+{
+   // Earlier names shadow later ones as in the linear search
+   ident_t id = tree_ident(t);
+   if (hash_get(index, id) == NULL)
+      hash_put(index, id, t);
+}
+
+static hash_t *build_name_index(tree_t block)
+{
+   const int ndecls = tree_decls(block);
+   const int ngenerics = tree_generics(block);
+   const int nstmts = tree_stmts(block);
+   const int nports = tree_ports(block);
+
+   hash_t *index = hash_new(ndecls + ngenerics + nstmts + nports);
+
+   for (int i = 0; i < ndecls; i++)
+      index_name(index, tree_decl(block, i));
+
+   for (int i = 0; i < ngenerics; i++)
+      index_name(index, tree_generic(block, i));
+
+   for (int i = 0; i < nstmts; i++)
+      index_name(index, tree_stmt(block, i));
+
+   for (int i = 0; i < nports; i++)
+      index_name(index, tree_port(block, i));
+
+   return index;
+}
+
+static tree_t select_name(tree_t where, ident_t id)
+{
+   // Blocks containing large generate statements are searched through
+   // a hash table attached to the corresponding runtime scope to avoid
+   // quadratic behaviour when binding an external name in each instance
+   rt_model_t *m = get_model_or_null();
+   if (m == NULL || tree_kind(where) != T_BLOCK)
+      return search_region(where, id);
+
+   rt_scope_t *s = find_scope(m, where);
+   if (s == NULL)
+      return search_region(where, id);
+   else if (s->names == NULL) {
+      if (tree_decls(where) + tree_stmts(where) < NAME_INDEX_MIN)
+         return search_region(where, id);
+
+      s->names = build_name_index(where);
+   }
+
+   return hash_get(s->names, id);
+}
+
 static bool is_implicit_block(tree_t block)
 {
    if (tree_kind(block) != T_BLOCK)
@@ -246,6 +303,13 @@ void x_bind_external(tree_t name, jit_handle_t scope, jit_scalar_t *args)
 
    void *ptr = jit_get_frame_var(j, handle, tree_ident(where));
 
+   if (tree_class(name) == C_SIGNAL && type_is_homogeneous(type)) {
+      // The signal may have been elaborated without storage for
+      // 'LAST_VALUE as the reference through this name was not visible
+      sig_shared_t *ss = *(sig_shared_t **)ptr;
+      signal_track_last_value(container_of(ss, rt_signal_t, shared));
+   }
+
    if (type_is_array(type) && type_const_bounds(type)) {
       const int ndims = dimension_of(type);
       jit_scalar_t *slots = jit_mspace_alloc(16 * (ndims + 1));
@@ -36,6 +36,7 @@
 #include "thread.h"
 #include "tree.h"
 #include "type.h"
+#include "vlog/vlog-defs.h"
 #include "vlog/vlog-node.h"
 
 #include <assert.h>
@@ -98,6 +99,12 @@ typedef struct {
    unsigned      max;
 } deferq_t;
 
+typedef struct {
+   void     *pending;
+   uint64_t  when;
+   int       iteration;
+} rt_sigwait_t;
+
 typedef struct _rt_model {
    tree_t             top;
    hash_t            *scopes;
@@ -114,6 +121,7 @@ typedef struct _rt_model {
    bool               next_is_delta;
    bool               force_stop;
    bool               blocking_update;
+   bool               keep_last_value;
    unsigned           n_signals;
    heap_t            *eventq_heap;
    ihash_t           *res_memo;
@@ -140,6 +148,8 @@ typedef struct _rt_model {
    bool               shuffle;
    bool               liveness;
    rt_trigger_t      *triggertab[TRIGGER_TAB_SIZE];
+   chash_t           *lazy_last;
+   chash_t           *sigwait;
 } rt_model_t;
 
 #define FMT_VALUES_SZ   128
@@ -147,6 +157,8 @@ typedef struct _rt_model {
 #define TRACE_SIGNALS   1
 #define WAVEFORM_CHUNK  256
 #define PENDING_MIN     4
+#define PENDING_INDEX   16
+#define DRIVER_HASH_MIN 8
 #define MAX_RANK        UINT8_MAX
 
 #define TRACE(...) do {                                 \
@@ -174,6 +186,9 @@ static void put_effective(rt_model_t *m, rt_nexus_t *n, const void *value);
 static void update_implicit_signal(rt_model_t *m, rt_implicit_t *imp);
 static bool run_trigger(rt_model_t *m, rt_trigger_t *t);
 static void wakeup_all(rt_model_t *m, void **pending);
+static void free_pending(rt_pending_t *p);
+static void free_sigwait_cb(const void *key, void *value);
+static void reindex_pending(rt_pending_t *p);
 static void reset_scope(rt_model_t *m, rt_scope_t *s);
 static void async_run_process(rt_model_t *m, void *arg);
 static void async_update_property(rt_model_t *m, void *arg);
@@ -491,6 +506,8 @@ rt_model_t *model_new(jit_t *jit, cover_data_t *cover)
    m->eventq_heap = heap_new(512);
    m->res_memo    = ihash_new(128);
    m->cover       = cover;
+   m->lazy_last   = chash_new(16);
+   m->sigwait     = chash_new(16);
 
    m->driving_heap   = heap_new(64);
    m->effective_heap = heap_new(64);
@@ -562,7 +579,7 @@ static void cleanup_nexus(rt_model_t *m, rt_nexus_t *n)
    }
 
    if (n->pending != NULL && pointer_tag(n->pending) == 0)
-      free(n->pending);
+      free_pending(untag_pointer(n->pending, rt_pending_t));
 }
 
 static void cleanup_signal(rt_model_t *m, rt_signal_t *s)
@@ -582,6 +599,10 @@ static void cleanup_scope(rt_model_t *m, rt_scope_t *scope)
       rt_proc_t *p = scope->procs.items[i];
       mptr_free(m->mspace, &(p->privdata));
       tlab_release(p->tlab);
+      if (p->drivers != NULL)
+         hash_free(p->drivers);
+      if (p->random != NULL)
+         random_free(p->random);
       free(p);
    }
    ACLEAR(scope->procs);
@@ -607,6 +628,9 @@ static void cleanup_scope(rt_model_t *m, rt_scope_t *scope)
       cleanup_scope(m, scope->children.items[i]);
    ACLEAR(scope->children);
 
+   if (scope->names != NULL)
+      hash_free(scope->names);
+
    mptr_free(m->mspace, &(scope->privdata));
    free(scope);
 }
@@ -673,6 +697,9 @@ void model_free(rt_model_t *m)
    heap_free(m->eventq_heap);
    hash_free(m->scopes);
    ihash_free(m->res_memo);
+   chash_free(m->lazy_last);
+   chash_iter(m->sigwait, free_sigwait_cb);
+   chash_free(m->sigwait);
    ACLEAR(m->eventsigs);
    free(m);
 }
@@ -725,8 +752,8 @@ rt_watch_t *find_watch(rt_nexus_t *n, sig_event_fn_t fn)
       rt_pending_t *p = untag_pointer(n->pending, rt_pending_t);
 
       for (int i = 0; i < p->count; i++) {
-         rt_wakeable_t *obj = untag_pointer(p->wake[i], rt_wakeable_t);
-         if (obj->kind == W_WATCH) {
+         rt_wakeable_t *obj = p->wake[i];
+         if (obj != NULL && obj->kind == W_WATCH) {
             rt_watch_t *w = container_of(obj, rt_watch_t, wakeable);
             if (w->fn == fn)
                return w;
@@ -745,6 +772,11 @@ rt_scope_t *create_scope(rt_model_t *m, tree_t block, rt_scope_t *parent)
 
       m->top = block;
 
+      // An external name may be bound to any signal after it has
+      // already changed value so the last value must always be kept
+      m->keep_last_value =
+         !!(tree_global_flags(block) & TREE_GF_EXTERNAL_NAME);
+
       m->root = xcalloc(sizeof(rt_scope_t));
       m->root->kind     = SCOPE_ROOT;
       m->root->where    = block;
@@ -775,7 +807,18 @@ rt_scope_t *create_scope(rt_model_t *m, tree_t block, rt_scope_t *parent)
       model_thread_t *thread = model_thread(m);
       thread->active_scope = s;
 
-      jit_handle_t handle = jit_lazy_compile(m->jit, s->name);
+      tree_t hier = tree_decl(block, 0);
+      assert(tree_kind(hier) == T_HIER);
+
+      jit_handle_t handle;
+      if (tree_flags(hier) & TREE_F_SHARED_UNIT) {
+         // Identical to an earlier instance whose unit is reused
+         handle = jit_lazy_compile(m->jit, tree_ident2(hier));
+         jit_alias(m->jit, s->name, handle);
+      }
+      else
+         handle = jit_lazy_compile(m->jit, s->name);
+
       if (handle == JIT_HANDLE_INVALID)
          fatal_trace("failed to compile %s", istr(s->name));
 
@@ -831,7 +874,8 @@ const void *signal_value(rt_signal_t *s)
 
 const void *signal_last_value(rt_signal_t *s)
 {
-   return s->shared.data + s->shared.size;
+   assert(s->shared.flags & SIG_F_LAST_VALUE);
+   return s->shared.data + 2*s->shared.size;
 }
 
 uint8_t signal_size(rt_signal_t *s)
@@ -976,8 +1020,15 @@ static void run_process(rt_model_t *m, rt_proc_t *proc)
 
    rt_wakeable_t *obj = &(proc->wakeable);
 
-   if (obj->trigger != NULL && !run_trigger(m, obj->trigger))
+   if (obj->trigger == NULL)
+      ;
+   else if (!run_trigger(m, obj->trigger))
       return;   // Filtered
+   else if (obj->guard) {
+      // Wait statement guards only apply until the process resumes
+      obj->trigger = NULL;
+      obj->guard = false;
+   }
 
    model_thread_t *thread = model_thread(m);
    assert(thread->tlab != NULL);
@@ -1103,21 +1154,29 @@ static inline void *nexus_effective(rt_nexus_t *n)
    return n->signal->shared.data + n->offset;
 }
 
-static inline void *nexus_last_value(rt_nexus_t *n)
+static inline void *nexus_last_value(rt_model_t *m, rt_nexus_t *n)
 {
-   return n->signal->shared.data + n->offset + n->signal->shared.size;
+   // Storage for the last value is only allocated for signals where
+   // 'LAST_VALUE may be read
+   rt_signal_t *s = n->signal;
+   if (likely(s->shared.flags & SIG_F_LAST_VALUE))
+      return s->shared.data + n->offset + 2*s->shared.size;
+   else if (s->shared.flags & SIG_F_LAST_LAZY)
+      return chash_get(m->lazy_last, s) + n->offset;
+   else
+      return NULL;
 }
 
 static inline void *nexus_driving(rt_nexus_t *n)
 {
    assert(n->flags & NET_F_EFFECTIVE);
-   return n->signal->shared.data + n->offset + 2*n->signal->shared.size;
+   return n->signal->shared.data + n->offset + n->signal->shared.size;
 }
 
 static inline void *nexus_initial(rt_nexus_t *n)
 {
    assert(n->flags & NET_F_HAS_INITIAL);
-   return n->signal->shared.data + n->offset + 2*n->signal->shared.size;
+   return n->signal->shared.data + n->offset + n->signal->shared.size;
 }
 
 static rt_value_t alloc_value(rt_model_t *m, rt_nexus_t *n)
@@ -1497,6 +1556,28 @@ static void split_value(rt_nexus_t *nexus, rt_value_t *v_new,
    }
 }
 
+static inline waveform_t *first_transaction(rt_source_t *d)
+{
+   // The pending transactions form a circular list and the current
+   // transaction points at the last of these so that appending to a
+   // long queue is constant time
+   waveform_t *tail = d->u.driver.waveforms.next;
+   return tail ? tail->next : NULL;
+}
+
+static inline void append_transaction(rt_source_t *d, waveform_t *w)
+{
+   waveform_t *tail = d->u.driver.waveforms.next;
+   if (tail == NULL)
+      w->next = w;
+   else {
+      w->next = tail->next;
+      tail->next = w;
+   }
+
+   d->u.driver.waveforms.next = w;
+}
+
 static void clone_source(rt_model_t *m, rt_nexus_t *nexus,
                          rt_source_t *old, int offset)
 {
@@ -1551,15 +1632,20 @@ static void clone_source(rt_model_t *m, rt_nexus_t *nexus,
          new->was_active = old->was_active;
 
          // Future transactions
-         for (w_old = w_old->next; w_old; w_old = w_old->next) {
-            w_new = (w_new->next = alloc_waveform(m));
-            w_new->when = w_old->when;
-            w_new->next = NULL;
+         waveform_t *tail = w_old->next;
+         for (w_old = first_transaction(old); w_old; ) {
+            waveform_t *w = alloc_waveform(m);
+            w->when = w_old->when;
+            w->next = NULL;
+
+            split_value(nexus, &w->value, &w_old->value, offset);
 
-            split_value(nexus, &w_new->value, &w_old->value, offset);
+            append_transaction(new, w);
 
             assert(w_old->when >= m->now);
-            deltaq_insert_driver(m, w_new->when - m->now, new);
+            deltaq_insert_driver(m, w->when - m->now, new);
+
+            w_old = (w_old == tail) ? NULL : w_old->next;
          }
       }
       break;
@@ -1614,13 +1700,22 @@ static rt_nexus_t *clone_nexus(rt_model_t *m, rt_nexus_t *old, int offset)
       new->pending = old->pending;
    else {
       rt_pending_t *old_p = untag_pointer(old->pending, rt_pending_t);
-      rt_pending_t *new_p = xmalloc_flex(sizeof(rt_pending_t), old_p->count,
+      rt_pending_t *new_p = xmalloc_flex(sizeof(rt_pending_t),
+                                         MAX(old_p->count, PENDING_MIN),
                                          sizeof(rt_wakeable_t *));
 
-      new_p->count = new_p->max = old_p->count;
+      new_p->max   = MAX(old_p->count, PENDING_MIN);
+      new_p->count = 0;
+      new_p->holes = 0;
+      new_p->index = NULL;
 
-      for (int i = 0; i < old_p->count; i++)
-         new_p->wake[i] = old_p->wake[i];
+      for (int i = 0; i < old_p->count; i++) {
+         if (old_p->wake[i] != NULL)
+            new_p->wake[new_p->count++] = old_p->wake[i];
+      }
+
+      if (new_p->count > PENDING_INDEX)
+         reindex_pending(new_p);
 
       new->pending = tag_pointer(new_p, 0);
    }
@@ -1770,6 +1865,28 @@ static void copy_sub_signal_sources(rt_scope_t *scope, void *buf, int stride)
       copy_sub_signal_sources(scope->children.items[i], buf, stride);
 }
 
+static void convert_native(rt_conv_func_t *cf)
+{
+   TRACE("native conversion %s to %s", istr(tree_ident(cf->insig->where)),
+         istr(tree_ident(cf->outsig->where)));
+
+   const uint8_t *in = cf->insig->shared.data + cf->inoff;
+
+   for (rt_source_t *s = cf->outputs; s; s = s->chain_output) {
+      if (s->tag != SOURCE_PORT || s->u.port.conv_func != cf)
+         continue;
+
+      rt_nexus_t *n = s->u.port.output;
+      assert(n->size == 1);
+
+      const uint8_t *src = in + n->offset - cf->outoff;
+      uint8_t *dst = value_ptr(n, &(s->u.port.conv_result));
+
+      for (int i = 0; i < n->width; i++)
+         dst[i] = cf->table[src[i]];
+   }
+}
+
 static void convert_driving(rt_conv_func_t *cf)
 {
    rt_model_t *m = get_model();
@@ -1783,6 +1900,11 @@ static void convert_driving(rt_conv_func_t *cf)
       cf->iteration = m->iteration;
    }
 
+   if (cf->table != NULL) {
+      convert_native(cf);
+      return;
+   }
+
    TRACE("call driving conversion function %pi",
          jit_get_name(m->jit, cf->driving.handle));
 
@@ -1810,6 +1932,11 @@ static void convert_effective(rt_conv_func_t *cf)
    cf->when = m->now;
    cf->iteration = m->iteration;
 
+   if (cf->table != NULL) {
+      convert_native(cf);
+      return;
+   }
+
    TRACE("call effective conversion function %pi",
          jit_get_name(m->jit, cf->effective.handle));
 
@@ -2136,7 +2263,9 @@ static void calculate_initial_value(rt_model_t *m, rt_nexus_t *n)
    }
    else {
       // Effective value is always the same as the driving value
-      memcpy(nexus_last_value(n), nexus_effective(n), n->size * n->width);
+      void *last = nexus_last_value(m, n);
+      if (last != NULL)
+         memcpy(last, nexus_effective(n), n->size * n->width);
    }
 }
 
@@ -2194,8 +2323,10 @@ static void dump_one_signal(rt_model_t *m, rt_scope_t *scope, rt_signal_t *s,
               nth == 0 ? tb_get(tb) : "+",
               n->width, n->size, n->n_sources, n_outputs, n->rank);
 
-      if (n->event_delta == m->iteration && n->last_event == m->now)
-         fprintf(stderr, "%s -> ", fmt_nexus(n, nexus_last_value(n)));
+      const void *last = nexus_last_value(m, n);
+      if (last != NULL && n->event_delta == m->iteration
+          && n->last_event == m->now)
+         fprintf(stderr, "%s -> ", fmt_nexus(n, last));
 
       fputs(fmt_nexus(n, nexus_effective(n)), stderr);
 
@@ -2543,6 +2674,63 @@ static void update_property(rt_model_t *m, rt_prop_t *prop)
    m->liveness |= prop->strong;
 }
 
+static void free_pending(rt_pending_t *p)
+{
+   if (p->index != NULL)
+      hash_free(p->index);
+
+   free(p);
+}
+
+static void reindex_pending(rt_pending_t *p)
+{
+   // Large sensitivity lists keep a map from each wakeable to its slot
+   // so subscribing and unsubscribing does not scan the whole list
+   if (p->index != NULL)
+      hash_free(p->index);
+
+   p->index = hash_new(p->count * 2);
+
+   for (int i = 0; i < p->count; i++) {
+      if (p->wake[i] != NULL)
+         hash_put(p->index, p->wake[i], (void *)(uintptr_t)(i + 1));
+   }
+}
+
+static void compact_pending(rt_pending_t *p)
+{
+   // Remove the holes left by clear_event preserving the order of the
+   // remaining entries
+   int wptr = 0;
+   for (int i = 0; i < p->count; i++) {
+      if (p->wake[i] != NULL)
+         p->wake[wptr++] = p->wake[i];
+   }
+
+   p->count = wptr;
+   p->holes = 0;
+
+   if (p->count > PENDING_INDEX)
+      reindex_pending(p);
+   else if (p->index != NULL) {
+      hash_free(p->index);
+      p->index = NULL;
+   }
+}
+
+static int find_pending(rt_pending_t *p, rt_wakeable_t *obj)
+{
+   if (p->index != NULL)
+      return (uintptr_t)hash_get(p->index, obj) - 1;
+
+   for (int i = 0; i < p->count; i++) {
+      if (p->wake[i] == obj)
+         return i;
+   }
+
+   return -1;
+}
+
 static void sched_event(rt_model_t *m, void **pending, rt_wakeable_t *obj)
 {
    if (*pending == NULL)
@@ -2556,6 +2744,8 @@ static void sched_event(rt_model_t *m, void **pending, rt_wakeable_t *obj)
                                      sizeof(rt_wakeable_t *));
       p->max = PENDING_MIN;
       p->count = 2;
+      p->holes = 0;
+      p->index = NULL;
       p->wake[0] = cur;
       p->wake[1] = obj;
 
@@ -2564,21 +2754,29 @@ static void sched_event(rt_model_t *m, void **pending, rt_wakeable_t *obj)
    else {
       rt_pending_t *p = untag_pointer(*pending, rt_pending_t);
 
-      for (int i = 0; i < p->count; i++) {
-         if (p->wake[i] == NULL || p->wake[i] == obj) {
-            p->wake[i] = obj;
-            return;
-         }
-      }
+      if (find_pending(p, obj) >= 0)
+         return;
 
       if (p->count == p->max) {
-         p->max = MAX(PENDING_MIN, p->max * 2);
-         p = xrealloc_flex(p, sizeof(rt_pending_t), p->max,
-                           sizeof(rt_wakeable_t *));
-         *pending = tag_pointer(p, 0);
+         if (p->holes > 0)
+            compact_pending(p);
+         else {
+            p->max = MAX(PENDING_MIN, p->max * 2);
+            p = xrealloc_flex(p, sizeof(rt_pending_t), p->max,
+                              sizeof(rt_wakeable_t *));
+            *pending = tag_pointer(p, 0);
+         }
       }
 
-      p->wake[p->count++] = obj;
+      // New entries are always appended so a process which resumes and
+      // then waits on the same signal again keeps its relative order
+      const int slot = p->count++;
+      p->wake[slot] = obj;
+
+      if (p->index != NULL)
+         hash_put(p->index, obj, (void *)(uintptr_t)(slot + 1));
+      else if (p->count > PENDING_INDEX)
+         reindex_pending(p);
    }
 }
 
@@ -2591,16 +2789,32 @@ static void clear_event(rt_model_t *m, void **pending, rt_wakeable_t *obj)
    }
    else if (*pending != NULL) {
       rt_pending_t *p = untag_pointer(*pending, rt_pending_t);
-      for (int i = 0; i < p->count; i++) {
-         if (p->wake[i] == obj) {
-            p->wake[i] = NULL;
-            return;
-         }
+
+      const int slot = find_pending(p, obj);
+      if (slot < 0)
+         return;
+
+      p->wake[slot] = NULL;
+      p->holes++;
+
+      if (p->index != NULL)
+         hash_delete(p->index, obj);
+
+      while (p->count > 0 && p->wake[p->count - 1] == NULL) {
+         p->count--;
+         p->holes--;
       }
+
+      if (p->count == 0) {
+         free_pending(p);
+         *pending = NULL;
+      }
+      else if (p->holes > p->count / 2)
+         compact_pending(p);
    }
 }
 
-static rt_source_t *find_driver(rt_nexus_t *nexus, rt_proc_t *proc)
+static rt_source_t *find_driver_slow(rt_nexus_t *nexus, rt_proc_t *proc)
 {
    // Try to find this process in the list of existing drivers
    for (rt_source_t *d = &(nexus->sources); d; d = d->chain_input) {
@@ -2611,31 +2825,77 @@ static rt_source_t *find_driver(rt_nexus_t *nexus, rt_proc_t *proc)
    return NULL;
 }
 
+static void cache_driver(rt_proc_t *proc, rt_nexus_t *nexus, rt_source_t *d)
+{
+   // Only the process itself may update its driver table as it can
+   // run concurrently with other processes
+   assert(proc == get_active_proc());
+
+   if (proc->drivers == NULL)
+      proc->drivers = hash_new(16);
+
+   hash_put(proc->drivers, nexus, d);
+}
+
+static rt_source_t *find_driver(rt_nexus_t *nexus, rt_proc_t *proc)
+{
+   if (likely(nexus->n_sources < DRIVER_HASH_MIN))
+      return find_driver_slow(nexus, proc);
+   else if (proc == NULL || proc != get_active_proc())
+      return find_driver_slow(nexus, proc);
+
+   // Resolved signals with many drivers keep a per-process table from
+   // nexus to driver source: entries never go stale as splitting a
+   // nexus leaves the existing source attached to the original nexus
+   // and a miss just falls back to a linear search
+   rt_source_t *d = NULL;
+   if (proc->drivers != NULL && (d = hash_get(proc->drivers, nexus)))
+      return d;
+   else if ((d = find_driver_slow(nexus, proc)))
+      cache_driver(proc, nexus, d);
+
+   return d;
+}
+
 static inline bool insert_transaction(rt_model_t *m, rt_nexus_t *nexus,
                                       rt_source_t *source, waveform_t *w,
                                       uint64_t when, uint64_t reject)
 {
-   waveform_t *last = &(source->u.driver.waveforms);
-   waveform_t *it   = last->next;
+   waveform_t *tail = source->u.driver.waveforms.next;
+   if (tail == NULL || tail->when < when - reject) {
+      // Fast path for transport delay lines and any other transaction
+      // scheduled after the pulse rejection interval of the last
+      // pending transaction: nothing can be rejected or truncated
+      append_transaction(source, w);
+      return false;
+   }
+
+   // Break the cycle and walk the queue from the first transaction
+   waveform_t *keep = NULL, **p = &keep;
+   waveform_t *it = tail->next;
+   tail->next = NULL;
+
    while (it != NULL && it->when < when) {
       // If the current transaction is within the pulse rejection interval
       // and the value is different to that of the new transaction then
       // delete the current transaction
       assert(it->when >= m->now);
+      waveform_t *next = it->next;
       if (it->when >= when - reject
           && !cmp_values(nexus, it->value, w->value)) {
-         waveform_t *next = it->next;
-         last->next = next;
          free_value(nexus, it->value);
          free_waveform(m, it);
-         it = next;
       }
       else {
-         last = it;
-         it = it->next;
+         *p = it;
+         p = &(it->next);
       }
+      it = next;
    }
-   last->next = w;
+
+   *p = w;
+   w->next = keep;
+   source->u.driver.waveforms.next = w;
 
    // Delete all transactions later than this
    // We could remove this transaction from the deltaq as well but the
@@ -2707,7 +2967,7 @@ static void sched_driver(rt_model_t *m, rt_nexus_t *n, uint64_t after,
          copy_value_ptr(n, &w0->value, prev);
 
          assert(d->u.driver.waveforms.next == NULL);
-         d->u.driver.waveforms.next = w0;
+         append_transaction(d, w0);
       }
 
       n->flags &= ~NET_F_FAST_DRIVER;
@@ -3043,6 +3303,25 @@ static void wakeup_all(rt_model_t *m, void **pending)
    }
 }
 
+static void wakeup_nexus(rt_model_t *m, rt_nexus_t *n)
+{
+   wakeup_all(m, &(n->pending));
+
+   if (n->signal->shared.flags & SIG_F_SENSITIVE) {
+      rt_sigwait_t *sw = chash_get(m->sigwait, n->signal);
+      if (m->blocking_update)
+         ;   // Objects may run again before the next event
+      else if (sw->when == m->now && sw->iteration == m->iteration)
+         return;   // Already woken for an earlier nexus in this cycle
+      else {
+         sw->when = m->now;
+         sw->iteration = m->iteration;
+      }
+
+      wakeup_all(m, &(sw->pending));
+   }
+}
+
 static void notify_event(rt_model_t *m, rt_nexus_t *n)
 {
    n->last_event = m->now;
@@ -3051,7 +3330,7 @@ static void notify_event(rt_model_t *m, rt_nexus_t *n)
    if (n->flags & NET_F_CACHE_EVENT)
       n->signal->shared.flags |= SIG_F_EVENT_FLAG;
 
-   wakeup_all(m, &(n->pending));
+   wakeup_nexus(m, n);
 }
 
 static void put_effective(rt_model_t *m, rt_nexus_t *n, const void *value)
@@ -3059,12 +3338,15 @@ static void put_effective(rt_model_t *m, rt_nexus_t *n, const void *value)
    TRACE("update %s effective value %s", trace_nexus(n), fmt_nexus(n, value));
 
    unsigned char *eff = nexus_effective(n);
-   unsigned char *last = nexus_last_value(n);
+   unsigned char *last = nexus_last_value(m, n);
 
    const size_t valuesz = n->size * n->width;
 
    if (!cmp_bytes(eff, value, valuesz)) {
-      copy2(last, eff, value, valuesz);
+      if (last != NULL)
+         copy2(last, eff, value, valuesz);
+      else
+         memcpy(eff, value, valuesz);
       notify_event(m, n);
    }
 }
@@ -3163,22 +3445,38 @@ static void update_driving(rt_model_t *m, rt_nexus_t *n, bool safe)
       defer_driving_update(m, n);
 }
 
+static void next_transaction(rt_model_t *m, rt_source_t *source)
+{
+   // Replace the current transaction with the first pending transaction
+   waveform_t *w_now = &(source->u.driver.waveforms);
+   waveform_t *w_tail = w_now->next;
+   waveform_t *w_next = w_tail->next;
+
+   w_now->when  = w_next->when;
+   w_now->value = w_next->value;
+
+   if (w_next == w_tail)
+      w_now->next = NULL;
+   else
+      w_tail->next = w_next->next;
+
+   free_waveform(m, w_next);
+}
+
 static void update_driver(rt_model_t *m, rt_nexus_t *n, rt_source_t *source)
 {
    waveform_t *w_now  = &(source->u.driver.waveforms);
-   waveform_t *w_next = w_now->next;
+   waveform_t *w_next = first_transaction(source);
 
    if (likely(w_next != NULL && w_next->when == m->now)) {
       free_value(n, w_now->value);
-      *w_now = *w_next;
-      free_waveform(m, w_next);
+      next_transaction(m, source);
       source->disconnected = 0;
       update_driving(m, n, false);
    }
    else if (unlikely(w_next != NULL && w_next->when == -m->now)) {
       // Disconnect source due to null transaction
-      *w_now = *w_next;
-      free_waveform(m, w_next);
+      next_transaction(m, source);
       source->disconnected = 1;
       update_driving(m, n, false);
    }
@@ -3720,12 +4018,15 @@ void deposit_signal(rt_model_t *m, rt_signal_t *s, const void *values,
       assert(count >= 0);
 
       unsigned char *eff = nexus_effective(n);
-      unsigned char *last = nexus_last_value(n);
+      unsigned char *last = nexus_last_value(m, n);
 
       const size_t valuesz = n->size * n->width;
 
       if (!cmp_bytes(eff, vptr, valuesz)) {
-         copy2(last, eff, vptr, valuesz);
+         if (last != NULL)
+            copy2(last, eff, vptr, valuesz);
+         else
+            memcpy(eff, vptr, valuesz);
          m->trigger_epoch++;
 
          n->last_event = m->now;
@@ -3733,7 +4034,7 @@ void deposit_signal(rt_model_t *m, rt_signal_t *s, const void *values,
 
          assert(!(n->flags & NET_F_CACHE_EVENT));
 
-         wakeup_all(m, &(n->pending));
+         wakeup_nexus(m, n);
 
          for (rt_source_t *o = n->outputs; o; o = o->chain_output) {
             assert(o->tag == SOURCE_PORT);
@@ -3848,6 +4149,7 @@ rt_watch_t *watch_new(rt_model_t *m, sig_event_fn_t fn, void *user,
                                 sizeof(rt_signal_t *));
    w->fn        = fn;
    w->chain_all = m->watches;
+   w->prev_all  = &(m->watches);
    w->user_data = user;
    w->num_slots = slots;
 
@@ -3856,6 +4158,9 @@ rt_watch_t *watch_new(rt_model_t *m, sig_event_fn_t fn, void *user,
    w->wakeable.pending   = false;
    w->wakeable.delayed   = false;
 
+   if (m->watches != NULL)
+      m->watches->prev_all = &(w->chain_all);
+
    m->watches = w;
 
    return w;
@@ -3871,20 +4176,15 @@ void watch_free(rt_model_t *m, rt_watch_t *w)
          clear_event(m, &(n->pending), &(w->wakeable));
    }
 
-   rt_watch_t **last = &m->watches;
-   for (rt_watch_t *it = *last; it;
-        last = &(it->chain_all), it = it->chain_all) {
-      if (it == w) {
-         *last = it->chain_all;
-         if (w->wakeable.pending)
-            w->wakeable.zombie = true;   // Will be freed in callback
-         else
-            free(w);
-         return;
-      }
-   }
+   // Unlink in constant time as coverage may retire many watches
+   *(w->prev_all) = w->chain_all;
+   if (w->chain_all != NULL)
+      w->chain_all->prev_all = w->prev_all;
 
-   should_not_reach_here();
+   if (w->wakeable.pending)
+      w->wakeable.zombie = true;   // Will be freed in callback
+   else
+      free(w);
 }
 
 rt_watch_t *model_set_event_cb(rt_model_t *m, rt_signal_t *s, rt_watch_t *w)
@@ -4193,12 +4493,18 @@ sig_shared_t *x_init_signal(int64_t count, uint32_t size, jit_scalar_t value,
               " sub-elements which is greater than the maximum supported %d",
               istr(tree_ident(where)), count, INT32_MAX);
 
-   const size_t datasz = MAX(3 * count * size, 8);
+   if (m->keep_last_value)
+      flags |= SIG_F_LAST_VALUE;
+
+   // The last value area at the end is omitted unless 'LAST_VALUE may
+   // be read from this signal
+   const int nvalues = (flags & SIG_F_LAST_VALUE) ? 3 : 2;
+   const size_t datasz = MAX(nvalues * count * size, 8);
    rt_signal_t *s = static_alloc(m, sizeof(rt_signal_t) + datasz);
    setup_signal(m, s, where, count, size, flags, offset);
 
    // The driving value area is also used to save the default value
-   void *driving = s->shared.data + 2*s->shared.size;
+   void *driving = s->shared.data + s->shared.size;
 
    if (scalar) {
 #define COPY_SCALAR(type) do {                  \
@@ -4230,18 +4536,16 @@ void x_drive_signal(sig_shared_t *ss, uint32_t offset, int32_t count)
    rt_proc_t *proc = get_active_proc();
    rt_nexus_t *n = split_nexus(m, s, offset, count);
    for (; count > 0; n = n->chain) {
-      rt_source_t *s;
-      for (s = &(n->sources); s; s = s->chain_input) {
-         if (s->tag == SOURCE_DRIVER && s->u.driver.proc == proc)
-            break;
-      }
-
+      rt_source_t *s = find_driver_slow(n, proc);
       if (s == NULL) {
          s = add_source(m, n, SOURCE_DRIVER);
          s->u.driver.waveforms.value = alloc_value(m, n);
          s->u.driver.proc = proc;
       }
 
+      if (proc != NULL && n->n_sources >= DRIVER_HASH_MIN)
+         cache_driver(proc, n, s);
+
       count -= n->width;
       assert(count >= 0);
    }
@@ -4420,6 +4724,36 @@ int32_t x_test_net_active(sig_shared_t *ss, uint32_t offset, int32_t count)
    return 0;
 }
 
+static bool is_whole_signal(rt_signal_t *s, uint32_t offset, int32_t count)
+{
+   return offset == 0 && count * s->nexus.size == s->shared.size;
+}
+
+static rt_sigwait_t *get_sigwait(rt_model_t *m, rt_signal_t *s)
+{
+   // Caller must hold the signal lock
+   rt_sigwait_t *sw = chash_get(m->sigwait, s);
+   if (sw == NULL) {
+      sw = xcalloc(sizeof(rt_sigwait_t));
+      sw->when = TIME_HIGH;
+      chash_put(m->sigwait, s, sw);
+
+      s->shared.flags |= SIG_F_SENSITIVE;
+   }
+
+   return sw;
+}
+
+static void free_sigwait_cb(const void *key, void *value)
+{
+   rt_sigwait_t *sw = value;
+
+   if (sw->pending != NULL && pointer_tag(sw->pending) == 0)
+      free_pending(untag_pointer(sw->pending, rt_pending_t));
+
+   free(sw);
+}
+
 void x_sched_event(sig_shared_t *ss, uint32_t offset, int32_t count)
 {
    rt_signal_t *s = container_of(ss, rt_signal_t, shared);
@@ -4431,6 +4765,19 @@ void x_sched_event(sig_shared_t *ss, uint32_t offset, int32_t count)
    rt_wakeable_t *obj = get_active_wakeable();
 
    rt_model_t *m = get_model();
+
+   if (is_whole_signal(s, offset, count)) {
+      // Register sensitivity to the entire signal once rather than on
+      // each nexus
+      rt_sigwait_t *sw = get_sigwait(m, s);
+      sched_event(m, &(sw->pending), obj);
+
+      // Make sure an event earlier in this cycle does not suppress the
+      // wakeup of this object
+      sw->when = TIME_HIGH;
+      return;
+   }
+
    rt_nexus_t *n = split_nexus(m, s, offset, count);
    for (; count > 0; n = n->chain) {
       sched_event(m, &(n->pending), obj);
@@ -4450,6 +4797,14 @@ void x_clear_event(sig_shared_t *ss, uint32_t offset, int32_t count)
 
    rt_model_t *m = get_model();
    rt_proc_t *proc = get_active_proc();
+
+   if (is_whole_signal(s, offset, count)) {
+      rt_sigwait_t *sw = chash_get(m->sigwait, s);
+      if (sw != NULL)
+         clear_event(m, &(sw->pending), &(proc->wakeable));
+      return;
+   }
+
    rt_nexus_t *n = split_nexus(m, s, offset, count);
    for (; count > 0; n = n->chain) {
       clear_event(m, &(n->pending), &(proc->wakeable));
@@ -4553,6 +4908,54 @@ int64_t x_last_active(sig_shared_t *ss, uint32_t offset, int32_t count)
    return last;
 }
 
+static bool start_lazy_last_value(rt_model_t *m, rt_signal_t *s)
+{
+   if (s->shared.flags & (SIG_F_LAST_VALUE | SIG_F_LAST_LAZY))
+      return true;
+
+   // The last value is the same as the current value until the first
+   // event so tracking can only start before then
+   rt_nexus_t *n = &(s->nexus);
+   for (unsigned i = 0; i < s->n_nexus; i++, n = n->chain) {
+      if (n->last_event != TIME_HIGH)
+         return false;
+   }
+
+   TRACE("start tracking last value of %s", istr(tree_ident(s->where)));
+
+   void *last = static_alloc(m, s->shared.size);
+   memcpy(last, s->shared.data, s->shared.size);
+   chash_put(m->lazy_last, s, last);
+
+   s->shared.flags |= SIG_F_LAST_LAZY;
+   return true;
+}
+
+void signal_track_last_value(rt_signal_t *s)
+{
+   RT_LOCK(s->lock);
+   (void)start_lazy_last_value(get_model(), s);
+}
+
+void *x_last_value(sig_shared_t *ss, uint32_t offset)
+{
+   rt_signal_t *s = container_of(ss, rt_signal_t, shared);
+   RT_LOCK(s->lock);
+
+   TRACE("_last_value %s offset=%d", istr(tree_ident(s->where)), offset);
+
+   // Slow path for signals elaborated without storage for the last
+   // value such as those referenced through an external name
+   rt_model_t *m = get_model();
+   if (!start_lazy_last_value(m, s))
+      jit_msg(NULL, DIAG_FATAL, "'LAST_VALUE of signal %s is not available "
+              "as the signal has already changed value and was elaborated "
+              "without storage for its last value",
+              istr(tree_ident(s->where)));
+
+   return chash_get(m->lazy_last, s) + offset * s->nexus.size;
+}
+
 void x_map_signal(sig_shared_t *src_ss, uint32_t src_offset,
                   sig_shared_t *dst_ss, uint32_t dst_offset, uint32_t count)
 {
@@ -4803,9 +5206,10 @@ sig_shared_t *x_implicit_signal(uint32_t count, uint32_t size, tree_t where,
 
    rt_model_t *m = get_model();
 
-   const size_t datasz = MAX(2 * count * size, 8);
+   const size_t datasz = MAX(3 * count * size, 8);
    rt_implicit_t *imp = static_alloc(m, sizeof(rt_implicit_t) + datasz);
-   setup_signal(m, &(imp->signal), where, count, size, SIG_F_IMPLICIT, 0);
+   setup_signal(m, &(imp->signal), where, count, size,
+                SIG_F_IMPLICIT | SIG_F_LAST_VALUE, 0);
 
    imp->closure = *closure;
    imp->delay = delay;
@@ -5091,9 +5495,101 @@ void x_add_trigger(void *ptr)
    TRACE("add trigger %p", ptr);
 
    rt_wakeable_t *obj = get_active_wakeable();
-   assert(obj->trigger == NULL);
 
-   obj->trigger = ptr;
+   if (model_thread(get_model())->tlab == NULL) {
+      // Added during reset: filters every wakeup of this object
+      assert(obj->trigger == NULL);
+      obj->trigger = ptr;
+   }
+   else if (obj->trigger == NULL || obj->guard) {
+      // Added before a wait statement: a necessary condition for the
+      // process to resume
+      assert(obj->kind == W_PROC);
+      obj->trigger = ptr;
+      obj->guard = true;
+   }
+}
+
+static uint8_t to_vhdl_logic[256], to_vhdl_net[256];
+static uint8_t to_verilog_logic[256], to_verilog_net[256];
+
+static void init_conversion_tables(void)
+{
+   // Values of STD_ULOGIC indexed by T_LOGIC
+   static const uint8_t logic_map[] = { 2, 3, 4, 0 };
+   memcpy(to_vhdl_logic, logic_map, sizeof(logic_map));
+
+   // T_NET_VALUE encodes strength0 and strength1 above the logic value
+   // and weak, medium, and small strengths map to L or H
+   for (int i = 0; i < 256; i++) {
+      const int s0 = (i >> 2) & 7, s1 = (i >> 5) & 7;
+      switch (i & 3) {
+      case 0: to_vhdl_net[i] = (s0 >= 1 && s0 <= 3) ? 6 : 2; break;
+      case 1: to_vhdl_net[i] = (s1 >= 1 && s1 <= 3) ? 7 : 3; break;
+      case 2: to_vhdl_net[i] = 4; break;
+      case 3: to_vhdl_net[i] = 0; break;
+      }
+   }
+
+   // T_LOGIC and T_NET_VALUE indexed by STD_ULOGIC
+   static const uint8_t std_logic_map[] = { 3, 3, 0, 1, 2, 3, 0, 1, 3 };
+   static const uint8_t std_net_map[] = {
+      219, 219, 216, 217, 2, 219, 108, 109, 219
+   };
+   memcpy(to_verilog_logic, std_logic_map, sizeof(std_logic_map));
+   memcpy(to_verilog_net, std_net_map, sizeof(std_net_map));
+}
+
+static const uint8_t *conversion_table(rt_model_t *m,
+                                       const ffi_closure_t *closure)
+{
+   // Port conversions between the standard logic types generated for
+   // mixed language instantiation are performed with a lookup table
+   // rather than calling the conversion function in NVC.VERILOG
+   static struct {
+      const char    *func;
+      const uint8_t *table;
+      ident_t        name;
+   } map[] = {
+      { "NVC.VERILOG.TO_VHDL(" T_LOGIC ")U", to_vhdl_logic },
+      { "NVC.VERILOG.TO_VHDL(" T_LOGIC_ARRAY ")Y", to_vhdl_logic },
+      { "NVC.VERILOG.TO_VHDL(" T_NET_VALUE ")U", to_vhdl_net },
+      { "NVC.VERILOG.TO_VHDL(" T_WIRE_ARRAY ")Y", to_vhdl_net },
+      { "NVC.VERILOG.TO_VERILOG(U)" T_LOGIC, to_verilog_logic },
+      { "NVC.VERILOG.TO_VERILOG(U)" T_NET_VALUE, to_verilog_net },
+      { "NVC.VERILOG.TO_VERILOG(Y)" T_NET_ARRAY, to_verilog_net },
+   };
+
+   INIT_ONCE({
+         init_conversion_tables();
+
+         for (int i = 0; i < ARRAY_LEN(map); i++)
+            map[i].name = ident_new(map[i].func);
+      });
+
+   ident_t suffix = ident_rfrom(jit_get_name(m->jit, closure->handle), '$');
+   if (suffix != ident_new("verilog_convert_in")
+       && suffix != ident_new("verilog_convert_out"))
+      return NULL;
+
+   tree_t param = tree_from_object(jit_get_object(m->jit, closure->handle));
+   if (param == NULL || tree_kind(param) != T_PARAM)
+      return NULL;
+
+   tree_t conv = tree_value(param);
+   if (tree_kind(conv) != T_CONV_FUNC && tree_subkind(param) == P_NAMED)
+      conv = tree_name(param);
+
+   if (tree_kind(conv) != T_CONV_FUNC)
+      return NULL;
+
+   ident_t func = tree_ident2(tree_ref(conv));
+   for (int i = 0; i < ARRAY_LEN(map); i++) {
+      if (map[i].name == func)
+         return map[i].table;
+   }
+
+   return NULL;
 }
 
 void *x_port_conversion(const ffi_closure_t *driving,
@@ -5125,6 +5621,12 @@ void *x_port_conversion(const ffi_closure_t *driving,
    cf->inputs    = cf->tail;
    cf->when      = TIME_HIGH;
    cf->iteration = UINT_MAX;
+   cf->table     = NULL;
+   cf->insig     = NULL;
+   cf->outsig    = NULL;
+
+   if (driving->handle == effective->handle)
+      cf->table = conversion_table(m, driving);
 
    return cf;
 }
@@ -5139,6 +5641,12 @@ void x_convert_in(void *ptr, sig_shared_t *ss, uint32_t offset, int32_t count)
    rt_conv_func_t *cf = ptr;
    rt_model_t *m = get_model();
 
+   if (cf->insig != NULL || s->nexus.size != 1)
+      cf->table = NULL;   // Cannot use native conversion
+
+   cf->insig = s;
+   cf->inoff = offset;
+
    rt_nexus_t *n = split_nexus(m, s, offset, count);
    for (; count > 0; n = n->chain) {
       count -= n->width;
@@ -5164,6 +5672,12 @@ void x_convert_out(void *ptr, sig_shared_t *ss, uint32_t offset, int32_t count)
 
    assert(cf->ninputs == 0);    // Add outputs first
 
+   if (cf->outsig != NULL || s->nexus.size != 1)
+      cf->table = NULL;   // Cannot use native conversion
+
+   cf->outsig = s;
+   cf->outoff = offset;
+
    rt_nexus_t *n = split_nexus(m, s, offset, count);
    for (; count > 0; n = n->chain) {
       count -= n->width;
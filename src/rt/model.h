@@ -83,6 +83,7 @@ void get_path_name(rt_scope_t *s, text_buf_t *tb);
 
 const void *signal_value(rt_signal_t *s);
 const void *signal_last_value(rt_signal_t *s);
+void signal_track_last_value(rt_signal_t *s);
 uint8_t signal_size(rt_signal_t *s);
 uint32_t signal_width(rt_signal_t *s);
 size_t signal_expand(rt_signal_t *s, uint64_t *buf, size_t max);
@@ -16,11 +16,17 @@
 //
 
 #include "util.h"
+#include "ident.h"
 #include "jit/jit.h"
 #include "option.h"
+#include "rt/model.h"
+#include "rt/random.h"
+#include "rt/structs.h"
 #include "thread.h"
 
 #include <assert.h>
+#include <stdlib.h>
+#include <string.h>
 
 #define MT_N       624
 #define MT_M       397
@@ -28,25 +34,62 @@
 #define UPPER_MASK 0x80000000UL
 #define LOWER_MASK 0x7FFFFFFFUL
 
-static uint32_t   mt[MT_N];
-static int        mti = MT_N + 1;
-static nvc_lock_t lock;
+typedef struct _rt_random {
+   uint32_t mt[MT_N];
+   int      mti;
+} rt_random_t;
 
-static void mt19937_init(uint32_t seed)
+static rt_random_t global = { .mti = MT_N + 1 };
+static nvc_lock_t  lock;
+
+static void mt19937_init(rt_random_t *r, uint32_t seed)
 {
-   mt[0] = seed;
-   for (mti = 1; mti < MT_N; mti++)
-      mt[mti] = 1812433253UL * (mt[mti - 1] ^ (mt[mti - 1] >> 30)) + mti;
+   r->mt[0] = seed;
+   for (r->mti = 1; r->mti < MT_N; r->mti++) {
+      const uint32_t prev = r->mt[r->mti - 1];
+      r->mt[r->mti] = 1812433253UL * (prev ^ (prev >> 30)) + r->mti;
+   }
+}
 
-   DEBUG_ONLY(debugf("initialised MT19937 with seed %08x", seed));
+static void mt19937_init_by_array(rt_random_t *r, const uint32_t *key,
+                                  int length)
+{
+   // Reference init_by_array from Matsumoto and Nishimura
+   mt19937_init(r, 19650218UL);
+
+   int i = 1, j = 0;
+   for (int k = MAX(MT_N, length); k > 0; k--) {
+      const uint32_t prev = r->mt[i - 1];
+      r->mt[i] = (r->mt[i] ^ ((prev ^ (prev >> 30)) * 1664525UL))
+         + key[j] + j;
+      i++, j++;
+      if (i >= MT_N) {
+         r->mt[0] = r->mt[MT_N - 1];
+         i = 1;
+      }
+      if (j >= length)
+         j = 0;
+   }
+
+   for (int k = MT_N - 1; k > 0; k--) {
+      const uint32_t prev = r->mt[i - 1];
+      r->mt[i] = (r->mt[i] ^ ((prev ^ (prev >> 30)) * 1566083941UL)) - i;
+      i++;
+      if (i >= MT_N) {
+         r->mt[0] = r->mt[MT_N - 1];
+         i = 1;
+      }
+   }
+
+   r->mt[0] = 0x80000000UL;
 }
 
-static uint32_t mt19937_next(void)
+static uint32_t mt19937_next(rt_random_t *r)
 {
    static const uint32_t mag01[2] = { 0x0UL, MATRIX_A };
-   uint32_t y;
+   uint32_t *mt = r->mt, y;
 
-   if (mti == MT_N) {
+   if (r->mti == MT_N) {
       // Twist
       int kk;
       for (kk = 0; kk < MT_N - MT_M; kk++) {
@@ -61,12 +104,12 @@ static uint32_t mt19937_next(void)
       y = (mt[MT_N - 1] & UPPER_MASK) | (mt[0] & LOWER_MASK);
       mt[MT_N - 1] = mt[MT_M - 1] ^ (y >> 1) ^ mag01[y & 0x1UL];
 
-      mti = 0;
+      r->mti = 0;
    }
    else
-      assert(mti < MT_N);
+      assert(r->mti < MT_N);
 
-   y = mt[mti++];
+   y = mt[r->mti++];
 
    // Tempering
    y ^= (y >> 11);
@@ -81,14 +124,56 @@ uint32_t get_random(void)
 {
    SCOPED_LOCK(lock);
 
-   if (mti > MT_N)
-      mt19937_init(opt_get_int(OPT_RANDOM_SEED));
+   if (global.mti > MT_N) {
+      const uint32_t seed = opt_get_int(OPT_RANDOM_SEED);
+      mt19937_init(&global, seed);
+
+      DEBUG_ONLY(debugf("initialised MT19937 with seed %08x", seed));
+   }
+
+   return mt19937_next(&global);
+}
 
-   return mt19937_next();
+rt_random_t *random_new(ident_t name)
+{
+   // The key is the global seed followed by the characters of the
+   // hierarchical name so each process has an independent sequence
+   // which does not depend on the order processes are scheduled
+   const char *str = istr(name);
+   const size_t len = strlen(str);
+   const int nwords = 1 + (len + 3) / 4;
+
+   uint32_t *key LOCAL = xcalloc_array(nwords, sizeof(uint32_t));
+   key[0] = opt_get_int(OPT_RANDOM_SEED);
+   for (size_t i = 0; i < len; i++)
+      key[1 + i / 4] |= (uint32_t)(uint8_t)str[i] << (8 * (i % 4));
+
+   rt_random_t *r = xmalloc(sizeof(rt_random_t));
+   mt19937_init_by_array(r, key, nwords);
+   r->mti = MT_N;
+   return r;
+}
+
+void random_free(rt_random_t *r)
+{
+   free(r);
+}
+
+uint32_t random_next(rt_random_t *r)
+{
+   return mt19937_next(r);
 }
 
 DLLEXPORT
 void _nvc_random_get_next(jit_scalar_t *args)
 {
-   args[0].integer = get_random();
+   rt_proc_t *proc = get_active_proc();
+   if (proc == NULL)
+      args[0].integer = get_random();
+   else {
+      if (proc->random == NULL)
+         proc->random = random_new(proc->name);
+
+      args[0].integer = random_next(proc->random);
+   }
 }
@@ -22,4 +22,8 @@
 
 uint32_t get_random(void);
 
+rt_random_t *random_new(ident_t name);
+void random_free(rt_random_t *r);
+uint32_t random_next(rt_random_t *r);
+
 #endif  // _RT_RANDOM_H
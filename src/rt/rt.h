@@ -60,6 +60,9 @@ typedef uint8_t net_flags_t;
 #define SIG_F_CACHE_EVENT  (1 << 10)
 #define SIG_F_EVENT_FLAG   (1 << 11)
 #define SIG_F_REGISTER     (1 << 12)
+#define SIG_F_LAST_VALUE   (1 << 13)
+#define SIG_F_LAST_LAZY    (1 << 14)
+#define SIG_F_SENSITIVE    (1 << 15)
 typedef uint32_t sig_flags_t;
 
 typedef enum {
@@ -17,6 +17,7 @@
 
 #include "util.h"
 #include "common.h"
+#include "hash.h"
 #include "ident.h"
 #include "jit/jit-exits.h"
 #include "jit/jit-ffi.h"
@@ -100,20 +101,12 @@ typedef struct {
    int64_t       file_line;
 } call_path_element_t;
 
-static ffi_uarray_t *to_line_n(const char *str, size_t len)
-{
-   char *buf = jit_mspace_alloc(len);
-   memcpy(buf, str, len);
+typedef struct {
+   jit_call_site_t     site;
+   call_path_element_t elem;
+} call_site_info_t;
 
-   ffi_uarray_t *u = jit_mspace_alloc(sizeof(ffi_uarray_t));
-   *u = ffi_wrap(buf, 1, len);
-   return u;
-}
-
-static ffi_uarray_t *to_line(const char *str)
-{
-   return to_line_n(str, strlen(str));
-}
+static ghash_t *call_site_cache = NULL;
 
 static int8_t errno_to_dir_open_status(void)
 {
@@ -168,6 +161,17 @@ static char *find_dir_separator(const char *str)
       return fwd;
 }
 
+static ffi_uarray_t *to_line(const char *str)
+{
+   // These strings are cached and shared between calls so must not be
+   // allocated in the garbage collected heap
+   const size_t len = strlen(str);
+   ffi_uarray_t *u = xmalloc(sizeof(ffi_uarray_t) + len);
+   memcpy(u + 1, str, len);
+   *u = ffi_wrap(u + 1, 1, len);
+   return u;
+}
+
 static ffi_uarray_t *to_absolute_path(const char *input)
 {
    if (is_absolute_path(input))
@@ -180,6 +184,65 @@ static ffi_uarray_t *to_absolute_path(const char *input)
       return to_line(buf);
 }
 
+static uint32_t call_site_hash(const void *key)
+{
+   const jit_call_site_t *site = key;
+   return mix_bits_64((uintptr_t)site->func) ^ site->irpos;
+}
+
+static bool call_site_cmp(const void *a, const void *b)
+{
+   const jit_call_site_t *sa = a, *sb = b;
+   return sa->func == sb->func && sa->irpos == sb->irpos;
+}
+
+static const call_path_element_t *get_call_site(const jit_call_site_t *site)
+{
+   if (call_site_cache == NULL)
+      call_site_cache = ghash_new(16, call_site_hash, call_site_cmp);
+   else {
+      call_site_info_t *info = ghash_get(call_site_cache, site);
+      if (info != NULL)
+         return &(info->elem);
+   }
+
+   jit_frame_t frame;
+   jit_resolve_call_site(site, &frame);
+
+   tree_t decl = tree_from_object(frame.object);
+   assert(decl != NULL);
+
+   call_site_info_t *info = xcalloc(sizeof(call_site_info_t));
+   info->site = *site;
+   info->elem.name = to_line(istr(tree_ident(decl)));
+   info->elem.file_line = frame.loc.first_line;
+
+   char *file LOCAL = xstrdup(loc_file_str(&frame.loc));
+   char *sep = find_dir_separator(file);
+
+   if (sep != NULL) {
+      *sep = '\0';
+      info->elem.file_name = to_line(sep + 1);
+      info->elem.file_path = to_absolute_path(file);
+   }
+   else {
+      info->elem.file_name = to_line(file);
+      info->elem.file_path = to_absolute_path(".");
+   }
+
+   ghash_put(call_site_cache, &(info->site), info);
+   return &(info->elem);
+}
+
+static const call_path_element_t *get_caller(void)
+{
+   jit_call_site_t sites[2];
+   if (jit_call_sites(sites, ARRAY_LEN(sites)) < 2)
+      fatal_trace("std.env function called without a caller");
+
+   return get_call_site(&(sites[1]));
+}
+
 static void to_time_record(const struct tm *tm, int us, time_record_t *tr)
 {
    assert(us >= 0);
@@ -583,37 +646,20 @@ void _std_env_dir_open(directory_t *dir, const uint8_t *path_ptr,
 DLLEXPORT
 void _std_env_get_call_path(jit_scalar_t *args, tlab_t *tlab)
 {
-   jit_stack_trace_t *stack LOCAL = jit_stack_trace();
+   // The strings for each frame are resolved once per call site and
+   // then shared between all subsequent calls
+   const unsigned count = jit_call_sites(NULL, 0);
+   jit_call_site_t *sites LOCAL = xmalloc_array(count, sizeof(jit_call_site_t));
+   jit_call_sites(sites, count);
 
    call_path_element_t *array =
-      jit_mspace_alloc(stack->count * sizeof(call_path_element_t));
-
-   for (int i = 0; i < stack->count; i++) {
-      jit_frame_t *frame = &(stack->frames[i]);
-      call_path_element_t *cpe = &(array[i]);
-
-      tree_t decl = tree_from_object(frame->object);
-      assert(decl != NULL);
-
-      cpe->name = to_line(istr(tree_ident(decl)));
-      cpe->file_line = frame->loc.first_line;
-
-      char *file LOCAL = xstrdup(loc_file_str(&frame->loc));
-      char *sep = find_dir_separator(file);
-
-      if (sep != NULL) {
-         *sep = '\0';
-         cpe->file_name = to_line(sep + 1);
-         cpe->file_path = to_absolute_path(file);
-      }
-      else {
-         cpe->file_name = to_line(file);
-         cpe->file_path = to_absolute_path(".");
-      }
-   }
+      jit_mspace_alloc(count * sizeof(call_path_element_t));
+
+   for (int i = 0; i < count; i++)
+      array[i] = *get_call_site(&(sites[i]));
 
    ffi_uarray_t *u = jit_mspace_alloc(sizeof(ffi_uarray_t));
-   *u = ffi_wrap(array, 0, stack->count - 1);
+   *u = ffi_wrap(array, 0, count - 1);
 
    args[0].pointer = u;
 }
@@ -621,38 +667,19 @@ void _std_env_get_call_path(jit_scalar_t *args, tlab_t *tlab)
 DLLEXPORT
 void _std_env_file_name(ffi_uarray_t **ptr)
 {
-   jit_stack_trace_t *stack LOCAL = jit_stack_trace();
-   assert(stack->count > 1);
-
-   const char *file = loc_file_str(&(stack->frames[1].loc));
-   const char *sep = find_dir_separator(file);
-   *ptr = to_line(sep ? sep + 1 : file);
+   *ptr = get_caller()->file_name;
 }
 
 DLLEXPORT
 void _std_env_file_path(ffi_uarray_t **ptr)
 {
-   jit_stack_trace_t *stack LOCAL = jit_stack_trace();
-   assert(stack->count > 1);
-
-   char *file LOCAL = xstrdup(loc_file_str(&(stack->frames[1].loc)));
-   char *sep = find_dir_separator(file);
-
-   if (sep == NULL)
-      *ptr = to_absolute_path(".");
-   else {
-      *sep = '\0';
-      *ptr = to_absolute_path(file);
-   }
+   *ptr = get_caller()->file_path;
 }
 
 DLLEXPORT
 int32_t _std_env_file_line(void)
 {
-   jit_stack_trace_t *stack LOCAL = jit_stack_trace();
-   assert(stack->count > 1);
-
-   return stack->frames[1].loc.first_line;
+   return get_caller()->file_line;
 }
 
 DLLEXPORT
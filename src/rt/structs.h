@@ -51,6 +51,7 @@ typedef struct {
    unsigned        postponed : 1;
    unsigned        delayed : 1;
    unsigned        zombie : 1;
+   unsigned        guard : 1;
    rt_trigger_t   *trigger;
 } rt_wakeable_t;
 
@@ -74,6 +75,8 @@ typedef struct _rt_proc {
    tlab_t        *tlab;
    rt_scope_t    *scope;
    mptr_t         privdata;
+   hash_t        *drivers;
+   rt_random_t   *random;
 } rt_proc_t;
 
 STATIC_ASSERT(sizeof(rt_proc_t) <= 128);
@@ -109,6 +112,8 @@ STATIC_ASSERT(sizeof(waveform_t) <= 24);
 typedef struct {
    unsigned       count;
    unsigned       max;
+   unsigned       holes;
+   hash_t        *index;
    rt_wakeable_t *wake[];
 } rt_pending_t;
 
@@ -140,6 +145,11 @@ typedef struct _rt_conv_func {
    rt_source_t   *outputs;
    uint64_t       when;
    unsigned       iteration;
+   const uint8_t *table;
+   rt_signal_t   *insig;
+   rt_signal_t   *outsig;
+   uint32_t       inoff;
+   uint32_t       outoff;
    conv_input_t   tail[];
 } rt_conv_func_t;
 
@@ -267,12 +277,14 @@ typedef struct _rt_scope {
    mptr_t           privdata;
    rt_scope_t      *parent;
    scope_list_t     children;
+   hash_t          *names;   // Index used to bind external names
 } rt_scope_t;
 
 typedef struct _rt_watch {
    rt_wakeable_t   wakeable;
    sig_event_fn_t  fn;
    rt_watch_t     *chain_all;
+   rt_watch_t    **prev_all;
    void           *user_data;
    unsigned        num_slots;
    unsigned        next_slot;
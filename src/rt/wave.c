@@ -22,6 +22,7 @@
 #include "fstapi.h"
 #include "hash.h"
 #include "jit/jit-layout.h"
+#include "mask.h"
 #include "option.h"
 #include "rt/model.h"
 #include "rt/rt.h"
@@ -50,6 +51,21 @@ typedef struct {
 
 typedef A(glob_t) glob_array_t;
 
+// All include and exclude globs compiled into a single NFA whose
+// positions are the characters of each pattern followed by a NUL
+// accepting position
+typedef struct {
+   char       *text;
+   unsigned    size;
+   unsigned    nincl;
+   bit_mask_t  start;
+   bit_mask_t  tail;
+} glob_nfa_t;
+
+typedef enum {
+   MATCH_NONE, MATCH_SOME, MATCH_ALL
+} glob_match_t;
+
 typedef struct _fst_data fst_data_t;
 
 typedef void (*fst_fmt_fn_t)(rt_watch_t *, fst_data_t *);
@@ -117,6 +133,7 @@ typedef struct _wave_dumper {
    hash_t        *typecache;
    fst_type_t    *datatypes[DT_STRING + 1];
    data_array_t   dumped;
+   glob_nfa_t    *globs;
 } wave_dumper_t;
 
 static glob_array_t incl;
@@ -124,7 +141,151 @@ static glob_array_t excl;
 
 static void fst_process_signal(wave_dumper_t *wd, rt_scope_t *scope, tree_t d,
                                type_t type, text_buf_t *tb);
-static bool wave_should_dump(rt_scope_t *scope, ident_t id);
+
+static glob_nfa_t *glob_compile(void)
+{
+   if (incl.count == 0 && excl.count == 0)
+      return NULL;
+
+   glob_nfa_t *nfa = xcalloc(sizeof(glob_nfa_t));
+
+   for (int i = 0; i < incl.count; i++)
+      nfa->nincl += incl.items[i].len + 1;
+
+   nfa->size = nfa->nincl;
+   for (int i = 0; i < excl.count; i++)
+      nfa->size += excl.items[i].len + 1;
+
+   nfa->text = xmalloc(nfa->size);
+   mask_init(&nfa->start, nfa->size);
+   mask_init(&nfa->tail, nfa->size);
+
+   unsigned pos = 0;
+   for (int i = 0; i < incl.count + excl.count; i++) {
+      const glob_t *g = i < incl.count
+         ? &(incl.items[i]) : &(excl.items[i - incl.count]);
+
+      memcpy(nfa->text + pos, g->text, g->len + 1);
+      mask_set(&nfa->start, pos);
+
+      // A star matches one or more characters so a trailing star
+      // accepts any non-empty suffix of the path
+      if (g->len > 0 && g->text[g->len - 1] == '*')
+         mask_set(&nfa->tail, pos + g->len - 1);
+
+      pos += g->len + 1;
+   }
+
+   assert(pos == nfa->size);
+   return nfa;
+}
+
+static void glob_free(glob_nfa_t *nfa)
+{
+   mask_free(&nfa->start);
+   mask_free(&nfa->tail);
+   free(nfa->text);
+   free(nfa);
+}
+
+static void glob_step(const glob_nfa_t *nfa, const bit_mask_t *in,
+                      bit_mask_t *out, char ch)
+{
+   mask_clearall(out);
+
+   for (unsigned p = 0; p < nfa->size; p++) {
+      if (!mask_test(in, p))
+         continue;
+      else if (nfa->text[p] == '*') {
+         mask_set(out, p);
+         mask_set(out, p + 1);
+      }
+      else if (nfa->text[p] == ch && ch != '\0')
+         mask_set(out, p + 1);
+   }
+}
+
+static void glob_advance(const glob_nfa_t *nfa, bit_mask_t *state, ident_t id)
+{
+   // Consume the next ":name" component of the lower case path
+   LOCAL_BIT_MASK tmp;
+   mask_init(&tmp, nfa->size);
+
+   glob_step(nfa, state, &tmp, ':');
+
+   for (const char *p = istr(id); *p != '\0'; p++) {
+      if (mask_popcount(&tmp) == 0)
+         break;
+
+      glob_step(nfa, &tmp, state, tolower_iso88591(*p));
+      mask_copy(&tmp, state);
+   }
+
+   mask_copy(state, &tmp);
+}
+
+static glob_match_t glob_classify(const glob_nfa_t *nfa,
+                                  const bit_mask_t *state)
+{
+   // Decide whether every, no, or only some signals below the scope
+   // whose path produced this state need to be dumped
+   bool incl_live = false, incl_all = false, excl_live = false;
+   for (unsigned p = 0; p < nfa->size; p++) {
+      if (!mask_test(state, p))
+         continue;
+      else if (p >= nfa->nincl) {
+         if (mask_test(&nfa->tail, p))
+            return MATCH_NONE;
+         excl_live = true;
+      }
+      else {
+         incl_live = true;
+         incl_all |= mask_test(&nfa->tail, p);
+      }
+   }
+
+   if (nfa->nincl > 0 && !incl_live)
+      return MATCH_NONE;
+   else if (excl_live)
+      return MATCH_SOME;
+   else if (nfa->nincl == 0 || incl_all)
+      return MATCH_ALL;
+   else
+      return MATCH_SOME;
+}
+
+static bool wave_should_dump(wave_dumper_t *wd, glob_match_t match,
+                             const bit_mask_t *state, ident_t id)
+{
+   switch (match) {
+   case MATCH_NONE:
+      return false;
+   case MATCH_ALL:
+      return true;
+   default:
+      break;
+   }
+
+   const glob_nfa_t *nfa = wd->globs;
+
+   LOCAL_BIT_MASK final;
+   mask_init(&final, nfa->size);
+   mask_copy(&final, state);
+
+   glob_advance(nfa, &final, id);
+
+   bool include = (nfa->nincl == 0);
+   for (unsigned p = 0; p < nfa->size; p++) {
+      if (nfa->text[p] != '\0' || !mask_test(&final, p))
+         continue;
+      else if (p >= nfa->nincl)
+         return false;
+      else
+         include = true;
+   }
+
+   return include;
+}
 
 static bool should_dump_array(tree_t where, unsigned length)
 {
@@ -1103,7 +1264,8 @@ static void fst_leave_scope(wave_dumper_t *wd)
    }
 }
 
-static void fst_walk_design(wave_dumper_t *wd, tree_t block)
+static void fst_walk_design(wave_dumper_t *wd, tree_t block,
+                            const bit_mask_t *parent)
 {
    tree_t h = tree_decl(block, 0);
    assert(tree_kind(h) == T_HIER);
@@ -1112,12 +1274,22 @@ static void fst_walk_design(wave_dumper_t *wd, tree_t block)
    if (scope == NULL)
       fatal_trace("missing scope for %s", istr(tree_ident(block)));
 
+   LOCAL_BIT_MASK state = {};
+   glob_match_t match = MATCH_ALL;
+   if (wd->globs != NULL) {
+      mask_init(&state, wd->globs->size);
+      mask_copy(&state, parent);
+      glob_advance(wd->globs, &state, tree_ident(block));
+      match = glob_classify(wd->globs, &state);
+   }
+
    LOCAL_TEXT_BUF tb = tb_new();
    fst_enter_scope(wd, tree_ref(h), scope, tb);
 
    if (tree_subkind(h) == T_COMPONENT && tree_stmts(block) > 0) {
       // Skip over implicit block statement created for component
-      // instantiation
+      // instantiation: like get_path_name this does not add another
+      // path component so the glob state is not advanced again
       block = tree_stmt(block, 0);
       assert(tree_kind(block) == T_BLOCK);
 
@@ -1127,7 +1299,7 @@ static void fst_walk_design(wave_dumper_t *wd, tree_t block)
    const int nports = tree_ports(block);
    for (int i = 0; i < nports; i++) {
       tree_t p = tree_port(block, i);
-      if (wave_should_dump(scope, tree_ident(p)))
+      if (wave_should_dump(wd, match, &state, tree_ident(p)))
          fst_process_signal(wd, scope, p, tree_type(p), tb);
    }
 
@@ -1136,7 +1308,7 @@ static void fst_walk_design(wave_dumper_t *wd, tree_t block)
       tree_t d = tree_decl(block, i);
       switch (tree_kind(d)) {
       case T_SIGNAL_DECL:
-         if (wave_should_dump(scope, tree_ident(d)))
+         if (wave_should_dump(wd, match, &state, tree_ident(d)))
             fst_process_signal(wd, scope, d, tree_type(d), tb);
          break;
       case T_VERILOG:
@@ -1145,7 +1317,7 @@ static void fst_walk_design(wave_dumper_t *wd, tree_t block)
             const vlog_kind_t kind = vlog_kind(v);
             if (kind != V_NET_DECL && kind != V_VAR_DECL)
                continue;
-            else if (wave_should_dump(scope, vlog_ident(v)))
+            else if (wave_should_dump(wd, match, &state, vlog_ident(v)))
                fst_process_verilog(wd, scope, d, v, tb);
          }
          break;
@@ -1159,7 +1331,7 @@ static void fst_walk_design(wave_dumper_t *wd, tree_t block)
       tree_t s = tree_stmt(block, i);
       switch (tree_kind(s)) {
       case T_BLOCK:
-         fst_walk_design(wd, s);
+         fst_walk_design(wd, s, &state);
          break;
       case T_PROCESS:
       case T_VERILOG:
@@ -1210,7 +1382,8 @@ void wave_dumper_restart(wave_dumper_t *wd, rt_model_t *m, jit_t *jit)
    wd->model     = m;
    wd->jit       = jit;
 
-   fst_walk_design(wd, tree_stmt(wd->top, 0));
+   fst_walk_design(wd, tree_stmt(wd->top, 0),
+                   wd->globs ? &(wd->globs->start) : NULL);
    fst_walk_packages(wd);
 
    if (wd->gtkw != NULL) {
@@ -1237,6 +1410,7 @@ wave_dumper_t *wave_dumper_new(const char *file, const char *gtkw_file,
    wd->top       = top;
    wd->last_time = UINT64_MAX;
    wd->typecache = hash_new(128);
+   wd->globs     = glob_compile();
 
    if (format == WAVE_FORMAT_VCD) {
 #if defined __CYGWIN__ || defined __MINGW32__
@@ -1291,6 +1465,10 @@ void wave_dumper_free(wave_dumper_t *wd)
    ACLEAR(wd->dumped);
 
    hash_free(wd->typecache);
+
+   if (wd->globs != NULL)
+      glob_free(wd->globs);
+
    free(wd);
 }
 
@@ -1343,29 +1521,3 @@ void wave_include_file(const char *base)
    char *exclf LOCAL = xasprintf("%s.exclude", base);
    wave_process_file(exclf, false);
 }
-
-static bool wave_should_dump(rt_scope_t *scope, ident_t id)
-{
-   if (excl.count == 0 && incl.count == 0)
-      return true;
-
-   LOCAL_TEXT_BUF tb = tb_new();
-   get_path_name(scope, tb);
-   tb_append(tb, ':');
-   tb_istr(tb, id);
-   tb_downcase(tb);
-
-   ident_t name = ident_new(tb_get(tb));
-
-   for (int i = 0; i < excl.count; i++) {
-      if (ident_glob(name, excl.items[i].text, excl.items[i].len))
-         return false;
-   }
-
-   for (int i = 0; i < incl.count; i++) {
-      if (ident_glob(name, incl.items[i].text, incl.items[i].len))
-         return true;
-   }
-
-   return (incl.count == 0);
-}
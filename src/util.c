@@ -1474,6 +1474,29 @@ void nvc_rusage(nvc_rusage_t *ru)
    last_ts = ts;
 }
 
+size_t nvc_peak_rss(void)
+{
+   // Peak resident set size in bytes without disturbing the CPU time
+   // deltas reported by nvc_rusage
+#ifndef __MINGW32__
+   struct rusage buf;
+   if (getrusage(RUSAGE_SELF, &buf) < 0)
+      fatal_errno("getrusage");
+
+#ifdef __APPLE__
+   return buf.ru_maxrss;
+#else
+   return buf.ru_maxrss * 1024;
+#endif
+#else
+   PROCESS_MEMORY_COUNTERS counters;
+   if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+      fatal_errno("GetProcessMemoryInfo");
+
+   return counters.PeakWorkingSetSize;
+#endif
+}
+
 #ifdef __MINGW32__
 static uint64_t file_time_to_nanos(LPFILETIME ft)
 {
@@ -1681,6 +1704,19 @@ void file_unlock(int fd)
 #endif
 }
 
+void replace_file(const char *from, const char *to)
+{
+   // Atomically replace the destination so concurrent readers either
+   // see the old file or the new one but never a partial write
+#ifdef __MINGW32__
+   if (!MoveFileEx(from, to, MOVEFILE_REPLACE_EXISTING))
+      fatal_errno("MoveFileEx: %s", to);
+#else
+   if (rename(from, to) != 0)
+      fatal_errno("rename: %s", to);
+#endif
+}
+
 void *map_file(int fd, size_t size)
 {
 #ifdef __MINGW32__
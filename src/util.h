@@ -348,6 +348,7 @@ typedef struct {
 } nvc_rusage_t;
 
 void nvc_rusage(nvc_rusage_t *ru);
+size_t nvc_peak_rss(void);
 
 typedef uint64_t timestamp_t;   // Nanoseconds
 
@@ -377,6 +378,7 @@ void progress(const char *fmt, ...)
 void file_read_lock(int fd);
 void file_write_lock(int fd);
 void file_unlock(int fd);
+void replace_file(const char *from, const char *to);
 
 void *map_file(int fd, size_t size);
 void unmap_file(void *ptr, size_t size);
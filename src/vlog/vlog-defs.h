@@ -26,4 +26,13 @@
 #define T_WIRE_ARRAY "24NVC.VERILOG.T_WIRE_ARRAY"
 #define T_STRENGTH "22NVC.VERILOG.T_STRENGTH"
 
+// Opcodes for the format programs generated for $display and $write
+typedef enum {
+   DISPLAY_END,
+   DISPLAY_TEXT,          // Length byte followed by characters
+   DISPLAY_VEC4,          // Radix, signedness, 32-bit size; two slots
+   DISPLAY_REAL,          // Radix; one slot
+   DISPLAY_TIME,          // Radix; current simulation time
+} display_op_t;
+
 #endif  // _VLOG_DEFS_H
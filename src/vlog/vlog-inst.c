@@ -26,6 +26,11 @@
 
 #include <assert.h>
 
+typedef struct {
+   vlog_node_t genvar;
+   bool        shareable;
+} share_check_t;
+
 static vlog_node_t bind_parameter(vlog_node_t decl, int nth, vlog_node_t inst)
 {
    vlog_node_t value = NULL;
@@ -232,3 +237,136 @@ vlog_node_t vlog_generate_instance(vlog_node_t v, vlog_node_t genvar,
    hash_free(map);
    return copy;
 }
+
+static bool uses_genvar(vlog_node_t v, vlog_node_t genvar)
+{
+   switch (vlog_kind(v)) {
+   case V_REF:
+      return vlog_ref(v) == genvar;
+   case V_NUMBER:
+   case V_STRING:
+   case V_REAL:
+      return false;
+   case V_UNARY:
+      return uses_genvar(vlog_value(v), genvar);
+   case V_BINARY:
+      return uses_genvar(vlog_left(v), genvar)
+         || uses_genvar(vlog_right(v), genvar);
+   case V_COND_EXPR:
+      return uses_genvar(vlog_value(v), genvar)
+         || uses_genvar(vlog_left(v), genvar)
+         || uses_genvar(vlog_right(v), genvar);
+   default:
+      return true;   // Conservative
+   }
+}
+
+static bool type_uses_genvar(vlog_node_t type, vlog_node_t genvar)
+{
+   if (vlog_kind(type) != V_DATA_TYPE)
+      return true;
+
+   const int nranges = vlog_ranges(type);
+   for (int i = 0; i < nranges; i++) {
+      vlog_node_t r = vlog_range(type, i);
+      if (uses_genvar(vlog_left(r), genvar)
+          || uses_genvar(vlog_right(r), genvar))
+         return true;
+   }
+
+   return false;
+}
+
+static void generate_share_cb(vlog_node_t v, void *context)
+{
+   share_check_t *sc = context;
+
+   // The genvar becomes a variable in the shared block so cannot
+   // appear anywhere that needs a constant at elaboration time
+   switch (vlog_kind(v)) {
+   case V_DIMENSION:
+      if (uses_genvar(vlog_left(v), sc->genvar)
+          || uses_genvar(vlog_right(v), sc->genvar))
+         sc->shareable = false;
+      break;
+   case V_PART_SELECT:
+      if (vlog_subkind(v) == V_RANGE_CONST
+          && uses_genvar(vlog_left(v), sc->genvar))
+         sc->shareable = false;
+      else if (uses_genvar(vlog_right(v), sc->genvar))
+         sc->shareable = false;
+      break;
+   case V_CONCAT:
+      if (vlog_has_value(v) && uses_genvar(vlog_value(v), sc->genvar))
+         sc->shareable = false;
+      break;
+   case V_NET_DECL:
+   case V_VAR_DECL:
+      if (type_uses_genvar(vlog_type(v), sc->genvar))
+         sc->shareable = false;
+      else if (vlog_has_value(v) && uses_genvar(vlog_value(v), sc->genvar))
+         sc->shareable = false;
+      break;
+   case V_LOCALPARAM:
+      if (uses_genvar(vlog_value(v), sc->genvar))
+         sc->shareable = false;
+      break;
+   case V_FUNC_DECL:
+   case V_TASK_DECL:
+   case V_CLASS_DECL:
+   case V_TYPE_DECL:
+   case V_GENVAR_DECL:
+      sc->shareable = false;
+      break;
+   default:
+      break;
+   }
+}
+
+vlog_node_t vlog_generate_block(vlog_node_t v, vlog_node_t genvar)
+{
+   assert(vlog_kind(v) == V_BLOCK);
+   assert(vlog_kind(genvar) == V_GENVAR_DECL);
+
+   const int nstmts = vlog_stmts(v);
+   for (int i = 0; i < nstmts; i++) {
+      switch (vlog_kind(vlog_stmt(v, i))) {
+      case V_ALWAYS:
+      case V_INITIAL:
+      case V_ASSIGN:
+      case V_GATE_INST:
+         break;
+      default:
+         return NULL;   // Nested scopes are elaborated for each iteration
+      }
+   }
+
+   share_check_t sc = {
+      .genvar    = genvar,
+      .shareable = true,
+   };
+   vlog_visit(v, generate_share_cb, &sc);
+
+   if (!sc.shareable)
+      return NULL;
+
+   vlog_node_t copy = vlog_copy(v, copy_generate_pred, v);
+
+   // Each iteration initialises this from the genvar value stored in
+   // its elaborated block
+   vlog_node_t param = vlog_new(V_GENVAR_DECL);
+   vlog_set_ident(param, vlog_ident(genvar));
+   vlog_set_type(param, vlog_type(genvar));
+   vlog_set_loc(param, vlog_loc(genvar));
+
+   vlog_add_decl(copy, param);
+
+   hash_t *map = hash_new(4);
+   hash_put(map, genvar, param);
+
+   vlog_rewrite(copy, fixup_refs_cb, map);
+   vlog_simp(copy);
+
+   hash_free(map);
+   return copy;
+}
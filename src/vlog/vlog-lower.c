@@ -16,12 +16,14 @@
 //
 
 #include "util.h"
+#include "array.h"
 #include "common.h"
 #include "diag.h"
 #include "hash.h"
 #include "ident.h"
 #include "mir/mir-node.h"
 #include "mir/mir-unit.h"
+#include "rt/rt.h"
 #include "type.h"
 #include "vlog/vlog-defs.h"
 #include "vlog/vlog-node.h"
@@ -55,6 +57,7 @@ typedef struct {
 typedef struct {
    mir_unit_t *mu;
    ihash_t    *temps;
+   unsigned    ndeferred;
 } vlog_gen_t;
 
 typedef enum {
@@ -72,6 +75,7 @@ static void vlog_lower_stmts(vlog_gen_t *g, vlog_node_t v);
 static mir_value_t vlog_lower_rvalue(vlog_gen_t *g, vlog_node_t v);
 static mir_value_t vlog_lower_with_context(vlog_gen_t *g, vlog_node_t v,
                                            mir_type_t context);
+static void vlog_lower_cleanup(vlog_gen_t *g);
 
 static const type_info_t *vlog_type_info(vlog_gen_t *g, vlog_node_t v)
 {
@@ -842,6 +846,363 @@ static mir_value_t vlog_lower_sys_tfcall(vlog_gen_t *g, vlog_node_t v)
    return result;
 }
 
+typedef struct {
+   A(uint8_t)   prog;
+   text_buf_t  *text;
+   mir_value_t *args;
+   int          nargs;
+} display_gen_t;
+
+static void vlog_display_text(display_gen_t *d)
+{
+   const char *str = tb_get(d->text);
+   for (size_t len = tb_len(d->text); len > 0;) {
+      const size_t chunk = MIN(len, UINT8_MAX);
+      APUSH(d->prog, DISPLAY_TEXT);
+      APUSH(d->prog, chunk);
+      for (size_t i = 0; i < chunk; i++)
+         APUSH(d->prog, *str++);
+      len -= chunk;
+   }
+
+   tb_rewind(d->text);
+}
+
+static void vlog_display_op(vlog_gen_t *g, display_gen_t *d, display_op_t op,
+                            char radix, mir_type_t type)
+{
+   APUSH(d->prog, op);
+   APUSH(d->prog, radix);
+
+   if (op == DISPLAY_VEC4) {
+      const int size = mir_get_size(g->mu, type);
+      APUSH(d->prog, mir_get_signed(g->mu, type));
+      for (int i = 0; i < 4; i++)
+         APUSH(d->prog, (size >> (i * 8)) & 0xff);
+   }
+}
+
+static void vlog_display_arg(vlog_gen_t *g, display_gen_t *d, vlog_node_t v,
+                             char radix)
+{
+   switch (vlog_kind(v)) {
+   case V_EMPTY:
+      return;
+   case V_STRING:
+      {
+         // String literals are always printed as text
+         number_t n = vlog_number(v);
+         for (int i = number_width(n) / 8 - 1; i >= 0; i--) {
+            const char ch = number_byte(n, i);
+            if (ch != '\0')
+               tb_append(d->text, ch);
+         }
+      }
+      return;
+   case V_NUMBER:
+      {
+         // Constant arguments are formatted once here
+         number_t n = vlog_number(v);
+
+         const uint64_t *abits, *bbits;
+         number_get(n, &abits, &bbits);
+
+         vec4_format(radix, number_width(n), number_signed(n), abits,
+                     bbits, d->text);
+      }
+      return;
+   case V_SYS_FCALL:
+      if (icmp(vlog_ident(v), "$time")) {
+         vlog_display_text(d);
+         vlog_display_op(g, d, DISPLAY_TIME, radix, MIR_NULL_TYPE);
+         return;
+      }
+      break;
+   default:
+      break;
+   }
+
+   mir_value_t value = vlog_lower_rvalue(g, v);
+   mir_type_t type = mir_get_type(g->mu, value);
+
+   vlog_display_text(d);
+
+   switch (mir_get_class(g->mu, type)) {
+   case MIR_TYPE_VEC2:
+      {
+         const int size = mir_get_size(g->mu, type);
+         const bool issigned = mir_get_signed(g->mu, type);
+         mir_type_t t_vec4 = mir_vec4_type(g->mu, size, issigned);
+         value = mir_build_cast(g->mu, t_vec4, value);
+      }
+      // Fall-through
+   case MIR_TYPE_VEC4:
+      vlog_display_op(g, d, DISPLAY_VEC4, radix, type);
+      break;
+   case MIR_TYPE_REAL:
+      vlog_display_op(g, d, DISPLAY_REAL, radix, type);
+      break;
+   default:
+      CANNOT_HANDLE(v);
+   }
+
+   d->args[d->nargs++] = value;
+}
+
+static void vlog_lower_display(vlog_gen_t *g, vlog_node_t v)
+{
+   // The format string is parsed here and turned into a compact
+   // program that formats argument values passed directly from the
+   // generated code without going through VPI
+
+   const int nparams = vlog_params(v);
+   const well_known_t which = is_well_known(vlog_ident(v));
+
+   display_gen_t d = {
+      .text  = tb_new(),
+      .args  = xmalloc_array(nparams + 1, sizeof(mir_value_t)),
+      .nargs = 1,
+   };
+
+   int pos = 0;
+   if (nparams > 0 && vlog_kind(vlog_param(v, 0)) == V_STRING) {
+      number_t fmt = vlog_number(vlog_param(v, pos++));
+      for (int i = number_width(fmt) / 8 - 1; i >= 0; i--) {
+         const char ch = number_byte(fmt, i);
+         if (ch != '%') {
+            tb_append(d.text, ch);
+            continue;
+         }
+
+         // Field widths are currently ignored
+         char spec = '\0';
+         while (i > 0 && isdigit_iso88591((spec = number_byte(fmt, --i))))
+            ;
+
+         switch (spec) {
+         case 's':
+         case 'd':
+         case 'b':
+         case 'x':
+         case 'h':
+         case 't':
+         case 'f':
+         case 'c':
+            if (pos < nparams)
+               vlog_display_arg(g, &d, vlog_param(v, pos++), spec);
+            break;
+         case '%':
+            tb_append(d.text, '%');
+            break;
+         default:
+            {
+               diag_t *dg = diag_new(DIAG_WARN, vlog_loc(v));
+               diag_printf(dg, "unknown format specifier '%c'", spec);
+               diag_emit(dg);
+            }
+         }
+      }
+   }
+
+   for (; pos < nparams; pos++) {
+      vlog_node_t p = vlog_param(v, pos);
+      if (vlog_kind(p) == V_EMPTY)
+         tb_append(d.text, ' ');
+      else
+         vlog_display_arg(g, &d, p, 'd');
+   }
+
+   if (which != W_DLR_WRITE)
+      tb_append(d.text, '\n');
+
+   vlog_display_text(&d);
+   APUSH(d.prog, DISPLAY_END);
+
+   mir_type_t t_uint8 = mir_int_type(g->mu, 0, UINT8_MAX);
+
+   mir_value_t *bytes LOCAL = xmalloc_array(d.prog.count, sizeof(mir_value_t));
+   for (int i = 0; i < d.prog.count; i++)
+      bytes[i] = mir_const(g->mu, t_uint8, d.prog.items[i]);
+
+   mir_type_t t_prog = mir_carray_type(g->mu, d.prog.count, t_uint8);
+   mir_value_t array = mir_const_array(g->mu, t_prog, bytes, d.prog.count);
+   d.args[0] = mir_build_address_of(g->mu, array);
+
+   mir_value_t locus = mir_build_locus(g->mu, vlog_to_object(v));
+   mir_build_syscall(g->mu, vlog_ident(v), MIR_NULL_TYPE, MIR_NULL_STAMP,
+                     locus, d.args, d.nargs);
+
+   ACLEAR(d.prog);
+   tb_free(d.text);
+   free(d.args);
+}
+
+static void vlog_lower_deferred_display(mir_unit_t *mu, object_t *obj)
+{
+   vlog_node_t v = vlog_from_object(obj);
+   assert(vlog_kind(v) == V_SYS_TCALL);
+
+   vlog_gen_t g = {
+      .mu = mu,
+   };
+
+   // Dummy return value to force function calling convention
+   mir_type_t t_offset = mir_offset_type(mu);
+   mir_set_result(mu, t_offset);
+
+   mir_type_t t_context = mir_context_type(mu, mir_get_parent(mu));
+   mir_add_param(mu, t_context, MIR_NULL_STAMP, ident_new("context"));
+
+   vlog_lower_display(&g, v);
+
+   mir_build_return(mu, mir_const(mu, t_offset, 0));
+
+   mir_optimise(mu, MIR_PASS_O1);
+   vlog_lower_cleanup(&g);
+}
+
+typedef struct {
+   mir_unit_t *mu;
+   bool        local;
+} local_ref_ctx_t;
+
+static void vlog_local_ref_cb(vlog_node_t v, void *context)
+{
+   local_ref_ctx_t *ctx = context;
+
+   int hops;
+   mir_value_t var = mir_search_object(ctx->mu, vlog_ref(v), &hops);
+   ctx->local |= (!mir_is_null(var) && hops == 0);
+}
+
+static bool vlog_can_defer_display(vlog_gen_t *g, vlog_node_t v)
+{
+   // The deferred function can only read objects in the enclosing
+   // instance and not the locals of a task or function
+   local_ref_ctx_t ctx = { .mu = g->mu };
+   vlog_visit_only(v, vlog_local_ref_cb, &ctx, V_REF);
+   return !ctx.local;
+}
+
+static mir_value_t vlog_lower_display_closure(vlog_gen_t *g, vlog_node_t v)
+{
+   // Generate a function that evaluates the arguments and prints them
+   // in the same way as $display when it is called by the runtime
+   ident_t parent = mir_get_parent(g->mu);
+   ident_t func = ident_sprintf("%s%s%u", istr(mir_get_name(g->mu,
+                                                              MIR_NULL_VALUE)),
+                                istr(vlog_ident(v)), g->ndeferred++);
+
+   mir_defer(mir_get_context(g->mu), func, parent, MIR_UNIT_FUNCTION,
+             vlog_lower_deferred_display, vlog_to_object(v));
+
+   mir_type_t t_offset = mir_offset_type(g->mu);
+   mir_type_t t_context = mir_context_type(g->mu, parent);
+
+   mir_value_t context = mir_build_context_upref(g->mu, 1);
+   return mir_build_closure(g->mu, func, context, t_context, t_offset);
+}
+
+typedef struct {
+   vlog_gen_t     *gen;
+   hset_t         *seen;
+   A(mir_value_t)  nets;
+} monitor_nets_ctx_t;
+
+static void vlog_monitor_nets_cb(vlog_node_t v, void *context)
+{
+   monitor_nets_ctx_t *ctx = context;
+
+   const vlog_kind_t kind = vlog_kind(v);
+   if (kind != V_REF && kind != V_HIER_REF)
+      return;
+
+   vlog_node_t decl = vlog_ref(v);
+   if (vlog_kind(decl) == V_PORT_DECL)
+      decl = vlog_ref(decl);
+
+   switch (vlog_kind(decl)) {
+   case V_NET_DECL:
+   case V_VAR_DECL:
+      break;
+   default:
+      return;
+   }
+
+   if (hset_contains(ctx->seen, decl))
+      return;
+
+   hset_insert(ctx->seen, decl);
+
+   vlog_select_t select = vlog_lower_select(ctx->gen, v);
+   if (mir_is_signal(ctx->gen->mu, select.obj))
+      APUSH(ctx->nets, select.obj);
+}
+
+static void vlog_lower_postponed_tcall(vlog_gen_t *g, vlog_node_t v)
+{
+   if (!vlog_can_defer_display(g, v)) {
+      diag_t *d = diag_new(DIAG_WARN, vlog_loc(v));
+      diag_printf(d, "arguments to %s that reference local variables are "
+                  "printed when the task is called", istr(vlog_ident(v)));
+      diag_emit(d);
+
+      vlog_lower_display(g, v);
+      return;
+   }
+
+   mir_type_t t_uint8 = mir_int_type(g->mu, 0, UINT8_MAX);
+   mir_type_t t_ptr = mir_pointer_type(g->mu, t_uint8);
+
+   // A null format program means the values are printed later by
+   // calling the closure
+   A(mir_value_t) args = AINIT;
+   APUSH(args, mir_build_null(g->mu, t_ptr));
+   APUSH(args, vlog_lower_display_closure(g, v));
+
+   if (is_well_known(vlog_ident(v)) == W_DLR_MONITOR) {
+      // Pass every signal read by the arguments so the runtime can
+      // print a new line whenever one of them changes
+      monitor_nets_ctx_t ctx = {
+         .gen  = g,
+         .seen = hset_new(16),
+      };
+      vlog_visit(v, vlog_monitor_nets_cb, &ctx);
+
+      mir_type_t t_offset = mir_offset_type(g->mu);
+      APUSH(args, mir_const(g->mu, t_offset, ctx.nets.count));
+
+      for (int i = 0; i < ctx.nets.count; i++)
+         APUSH(args, ctx.nets.items[i]);
+
+      ACLEAR(ctx.nets);
+      hset_free(ctx.seen);
+   }
+
+   mir_value_t locus = mir_build_locus(g->mu, vlog_to_object(v));
+   mir_build_syscall(g->mu, vlog_ident(v), MIR_NULL_TYPE, MIR_NULL_STAMP,
+                     locus, args.items, args.count);
+
+   ACLEAR(args);
+}
+
+static void vlog_lower_sys_tcall(vlog_gen_t *g, vlog_node_t v)
+{
+   switch (is_well_known(vlog_ident(v))) {
+   case W_DLR_DISPLAY:
+   case W_DLR_WRITE:
+      vlog_lower_display(g, v);
+      break;
+   case W_DLR_STROBE:
+   case W_DLR_MONITOR:
+      vlog_lower_postponed_tcall(g, v);
+      break;
+   default:
+      vlog_lower_sys_tfcall(g, v);
+      break;
+   }
+}
+
 static mir_value_t vlog_lower_sys_fcall(vlog_gen_t *g, vlog_node_t v)
 {
    switch (is_well_known(vlog_ident(v))) {
@@ -1310,6 +1671,7 @@ static mir_value_t vlog_lower_trigger(vlog_gen_t *g, vlog_node_t v)
             }
          case V_PARAM_DECL:
          case V_LOCALPARAM:
+         case V_GENVAR_DECL:
             return MIR_NULL_VALUE;
          default:
             CANNOT_HANDLE(v);
@@ -1862,7 +2224,7 @@ static void vlog_lower_stmts(vlog_gen_t *g, vlog_node_t v)
          vlog_lower_stmts(g, s);
          break;
       case V_SYS_TCALL:
-         vlog_lower_sys_tfcall(g, s);
+         vlog_lower_sys_tcall(g, s);
          break;
       case V_IF:
          vlog_lower_if(g, s);
@@ -1998,6 +2360,7 @@ static void vlog_lower_sensitivity(vlog_gen_t *g, vlog_node_t v)
             break;
          case V_PARAM_DECL:
          case V_LOCALPARAM:
+         case V_GENVAR_DECL:
             break;
          default:
             CANNOT_HANDLE(v);
@@ -2295,7 +2658,7 @@ static void vlog_lower_net_decl(vlog_gen_t *g, vlog_node_t v, tree_t wrap,
    mir_value_t value = mir_const(g->mu, t_net_value, LOGIC_X);
    mir_value_t count = mir_const(g->mu, t_offset, total_size);
    mir_value_t size = mir_const(g->mu, t_offset, 1);
-   mir_value_t flags = mir_const(g->mu, t_offset, 0);
+   mir_value_t flags = mir_const(g->mu, t_offset, SIG_F_LAST_VALUE);
    mir_value_t locus = mir_build_locus(g->mu, tree_to_object(wrap));
 
    mir_value_t signal = mir_build_init_signal(g->mu, t_net_value, count, size,
@@ -2352,7 +2715,7 @@ static void vlog_lower_var_decl(vlog_gen_t *g, vlog_node_t v, tree_t wrap)
 
    mir_value_t count = mir_const(g->mu, t_offset, total_size);
    mir_value_t size = mir_const(g->mu, t_offset, ti->elemsz);
-   mir_value_t flags = mir_const(g->mu, t_offset, 0);
+   mir_value_t flags = mir_const(g->mu, t_offset, SIG_F_LAST_VALUE);
    mir_value_t locus = mir_build_locus(g->mu, tree_to_object(wrap));
 
    mir_value_t signal = mir_build_init_signal(g->mu, ti->unpacked, count, size,
@@ -2366,13 +2729,23 @@ static void vlog_lower_var_decl(vlog_gen_t *g, vlog_node_t v, tree_t wrap)
    mir_put_object(g->mu, v, var);
 }
 
-static void vlog_lower_genvar_decl(vlog_gen_t *g, vlog_node_t v)
+static void vlog_lower_genvar_decl(vlog_gen_t *g, vlog_node_t v, tree_t param)
 {
    const type_info_t *ti = vlog_type_info(g, vlog_type(v));
 
    mir_value_t var = mir_add_var(g->mu, ti->type, MIR_NULL_STAMP,
                                  vlog_ident(v), 0);
-   mir_build_store(g->mu, var, mir_const_vec(g->mu, ti->type, ~0, ~0));
+
+   mir_value_t init;
+   if (param != NULL) {
+      // Value of the genvar for this iteration of a shared generate block
+      mir_value_t value = vlog_lower_rvalue(g, tree_vlog(param));
+      init = mir_build_cast(g->mu, ti->type, value);
+   }
+   else
+      init = mir_const_vec(g->mu, ti->type, ~0, ~0);
+
+   mir_build_store(g->mu, var, init);
 
    mir_put_object(g->mu, v, var);
 }
@@ -2669,7 +3042,7 @@ void vlog_lower_block(mir_context_t *mc, ident_t parent, tree_t b)
    assert(tree_kind(hier) == T_HIER);
 
    mir_shape_t *shape = mir_get_shape(mc, parent);
-   ident_t qual = tree_ident2(hier);
+   ident_t qual = tree_ident(hier);
    mir_unit_t *mu = mir_unit_new(mc, qual, tree_to_object(b),
                                  MIR_UNIT_INSTANCE, shape);
 
@@ -2734,7 +3107,7 @@ void vlog_lower_block(mir_context_t *mc, ident_t parent, tree_t b)
          vlog_lower_var_decl(&g, d, hash_get(map, d));
          break;
       case V_GENVAR_DECL:
-         vlog_lower_genvar_decl(&g, d);
+         vlog_lower_genvar_decl(&g, d, hash_get(map, d));
          break;
       case V_LOCALPARAM:
          break;  // Always inlined for now
@@ -1338,6 +1338,120 @@ void vec2_itoa(int size, const uint64_t *a, text_buf_t *tb)
    }
 }
 
+static int vec4_dec_size(int nr_bits)
+{
+   // From Icarus Verilog vpi/sys_display.c
+   return (nr_bits * 146L + 484) / 485;
+}
+
+static bool vec4_is_defined(int size, const uint64_t *bbits)
+{
+   for (int i = 0; i < BIGNUM_WORDS(size); i++) {
+      if (bbits[i] != 0)
+         return false;
+   }
+
+   return true;
+}
+
+void vec4_itoa(int size, bool issigned, const uint64_t *abits,
+               const uint64_t *bbits, text_buf_t *tb)
+{
+   const int nwords = BIGNUM_WORDS(size);
+
+   if (!vec4_is_defined(size, bbits))
+      tb_append(tb, 'x');
+   else if (issigned)
+      vec2_itoa(size, abits, tb);
+   else if (size == 64)
+      tb_printf(tb, "%"PRIu64, abits[0]);
+   else {
+      // Widen by one bit so the value is always non-negative
+      uint64_t tmp[BIGNUM_WORDS(size + 1)];
+      memcpy(tmp, abits, nwords * sizeof(uint64_t));
+      if (BIGNUM_WORDS(size + 1) > nwords)
+         tmp[nwords] = 0;
+
+      vec2_itoa(size + 1, tmp, tb);
+   }
+}
+
+void vec4_format(char radix, int size, bool issigned, const uint64_t *abits,
+                 const uint64_t *bbits, text_buf_t *tb)
+{
+   const int nwords = BIGNUM_WORDS(size);
+   const bool is_defined = vec4_is_defined(size, bbits);
+
+   switch (radix) {
+   case 'd':
+   case 't':
+      {
+         const size_t start = tb_len(tb);
+
+         vec4_itoa(size, issigned, abits, bbits, tb);
+
+         const int len = tb_len(tb) - start, dmax = vec4_dec_size(size);
+         if (len < dmax) {
+            char digits[len];
+            memcpy(digits, tb_get(tb) + start, len);
+
+            tb_trim(tb, start);
+            tb_repeat(tb, ' ', dmax - len);
+            tb_catn(tb, digits, len);
+         }
+      }
+      break;
+
+   case 'x':
+   case 'h':
+      if (is_defined) {
+         for (int i = nwords - 1, field = ((size % 64) + 3) / 4;
+              i >= 0; i--, field = 16)
+            tb_printf(tb, "%0*"PRIx64, field ?: 16, abits[i]);
+      }
+      else
+         tb_repeat(tb, 'x', (size + 3) / 4);
+      break;
+
+   case 'b':
+      for (int i = size - 1; i >= 0; i--) {
+         const vlog_logic_t bit =
+            ((bbits[i / 64] >> (i % 64)) & 1) << 1
+            | ((abits[i / 64] >> (i % 64)) & 1);
+         static const char map[] = "01zx";
+         tb_append(tb, map[bit]);
+      }
+      break;
+
+   case 's':
+      if (is_defined) {
+         for (int i = (size - 7) & ~7; i >= 0; i -= 8) {
+            const char ch = abits[i / 64] >> (i % 64);
+            if (ch != '\0')
+               tb_append(tb, ch);
+         }
+      }
+      break;
+
+   case 'c':
+      tb_append(tb, is_defined ? abits[0] & 0xff : '\0');
+      break;
+
+   case 'f':
+      {
+         int64_t sext = abits[0];
+         if (issigned && size < 64 && (sext & (UINT64_C(1) << (size - 1))))
+            sext |= ~UINT64_C(0) << size;
+
+         tb_printf(tb, "%f", issigned ? (double)sext : (double)abits[0]);
+      }
+      break;
+
+   default:
+      should_not_reach_here();
+   }
+}
+
 static void vec4_make_undef(int size, uint64_t *a, uint64_t *b)
 {
   for (int i = 0; i < BIGNUM_WORDS(size); i++) {
@@ -109,6 +109,10 @@ int vec2_sle(int size, const uint64_t *a, const uint64_t *b);
 int vec2_le(int size, const uint64_t *a, const uint64_t *b);
 
 void vec2_itoa(int size, const uint64_t *a, text_buf_t *tb);
+void vec4_itoa(int size, bool issigned, const uint64_t *abits,
+               const uint64_t *bbits, text_buf_t *tb);
+void vec4_format(char radix, int size, bool issigned, const uint64_t *abits,
+                 const uint64_t *bbits, text_buf_t *tb);
 
 void vec4_add(int size, uint64_t *a1, uint64_t *b1, const uint64_t *a2,
               const uint64_t *b2);
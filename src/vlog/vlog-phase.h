@@ -34,5 +34,6 @@ vlog_node_t vlog_new_instance(vlog_node_t mod, vlog_node_t inst,
                               ident_t prefix);
 vlog_node_t vlog_generate_instance(vlog_node_t v, vlog_node_t genvar,
                                    int32_t value, ident_t prefix);
+vlog_node_t vlog_generate_block(vlog_node_t v, vlog_node_t genvar);
 
 #endif  // _VLOG_PHASE_H
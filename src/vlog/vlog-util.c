@@ -86,6 +86,12 @@ bool vlog_is_const(vlog_node_t v)
       return vlog_is_const(vlog_ref(v));
    case V_LOCALPARAM:
       return vlog_is_const(vlog_value(v));
+   case V_GENVAR_DECL:
+      return true;   // Parameter of a shared generate block
+   case V_UNARY:
+      return vlog_is_const(vlog_value(v));
+   case V_BINARY:
+      return vlog_is_const(vlog_left(v)) && vlog_is_const(vlog_right(v));
    default:
       return false;
    }
@@ -204,6 +210,7 @@ vlog_node_t vlog_longest_static_prefix(vlog_node_t v)
       switch (vlog_kind(vlog_ref(v))) {
       case V_PARAM_DECL:
       case V_LOCALPARAM:
+      case V_GENVAR_DECL:
          return NULL;
       default:
          return v;
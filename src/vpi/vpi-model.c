@@ -710,6 +710,34 @@ static void build_parameter(vlog_node_t v, c_abstractScope *scope)
    vpi_list_add(&scope->decls.list, &(param->decl.object));
 }
 
+static void build_genvar(vlog_node_t v, c_abstractScope *scope)
+{
+   c_genScope *gs = is_genScope(&(scope->object));
+   if (gs == NULL)
+      return;
+
+   // The genvar of a shared generate block takes its value from the
+   // elaborated block for each iteration
+   ident_t id = vlog_ident(v);
+   const int ndecls = tree_decls(gs->block);
+   for (int i = 0; i < ndecls; i++) {
+      tree_t d = tree_decl(gs->block, i);
+      if (tree_kind(d) != T_VERILOG || tree_ident(d) != id)
+         continue;
+
+      vlog_node_t value = tree_vlog(d);
+      if (vlog_kind(value) != V_NUMBER)
+         continue;
+
+      c_parameter *param = new_object(sizeof(c_parameter), vpiParameter);
+      init_abstractDecl(&(param->decl), v, scope);
+      param->value = build_expr(value, scope);
+
+      vpi_list_add(&scope->decls.list, &(param->decl.object));
+      return;
+   }
+}
+
 static bool init_iterator(c_iterator *it, PLI_INT32 type, c_vpiObject *obj)
 {
    c_tfCall *call = is_tfCall(obj);
@@ -836,6 +864,29 @@ static bool vpi_get_range(c_vpiObject *obj, int64_t *ileft, int64_t *iright)
    return true;
 }
 
+bool vpi_get_memory(vpiHandle handle, vpi_memory_t *mem)
+{
+   c_vpiObject *obj = from_handle(handle);
+   if (obj == NULL)
+      return false;
+
+   c_regArray *arr = is_regArray(obj);
+   if (arr == NULL) {
+      vpi_error(vpiError, &(obj->loc), "%s is not a memory",
+                handle_pp(handle));
+      return false;
+   }
+
+   if (!vpi_get_range(obj, &mem->left, &mem->right))
+      return false;
+
+   sig_shared_t **ss = vpi_get_ptr(&arr->decl);
+   mem->signal = container_of(*ss, rt_signal_t, shared);
+   mem->width  = vlog_size(vlog_type(arr->decl.where));
+
+   return true;
+}
+
 static void vpi_lazy_decls(c_vpiObject *obj)
 {
    c_abstractScope *s = is_abstractScope(obj);
@@ -857,6 +908,9 @@ static void vpi_lazy_decls(c_vpiObject *obj)
       case V_LOCALPARAM:
          build_parameter(v, s);
          break;
+      case V_GENVAR_DECL:
+         build_genvar(v, s);
+         break;
       default:
          break;
       }
@@ -37,4 +37,13 @@ void vpi_clear_error(void);
 void vpi_format_number(int size, const uint64_t *abits, const uint64_t *bbits,
                        s_vpi_value *val, text_buf_t *tb);
 
+typedef struct {
+   rt_signal_t *signal;
+   int64_t      left;
+   int64_t      right;
+   unsigned     width;
+} vpi_memory_t;
+
+bool vpi_get_memory(vpiHandle handle, vpi_memory_t *mem);
+
 #endif  // _VPI_PRIV_H
@@ -23,6 +23,7 @@
 #include "svrand.h"
 #include "thread.h"
 #include "vpi/vpi-priv.h"
+#include "vlog/vlog-number.h"
 
 #include <assert.h>
 #include <inttypes.h>
@@ -30,276 +31,356 @@
 #include <stdio.h>
 #include <string.h>
 
-static void format_string(vpiHandle it, int fwidth)
+static PLI_INT32 finish_tf(PLI_BYTE8 *userdata)
 {
-   vpiHandle arg = vpi_scan(it);
-   if (arg == NULL)
-      return;
+   notef("$finish called");
+   jit_abort();
+}
+
+static PLI_INT32 fatal_tf(PLI_BYTE8 *userdata)
+{
+   diag_t *d = diag_new(DIAG_FATAL, NULL);
+   diag_printf(d, "$fatal called");
+   diag_emit(d);
 
-   s_vpi_value argval = { .format = vpiStringVal };
-   vpi_get_value(arg, &argval);
+   jit_abort_with_status(1);
+}
 
-   fputs(argval.value.str, stdout);
+typedef enum {
+   DIGIT_X = 16,
+   DIGIT_Z,
+   DIGIT_SKIP,
+   DIGIT_INVALID,
+} mem_digit_t;
+
+typedef struct {
+   vpi_memory_t mem;
+   char        *fname;
+   int64_t      low;
+   int64_t      high;
+   int64_t      start;
+   int64_t      end;
+   bool         has_end;
+} mem_task_t;
+
+static uint8_t digit_map[256];
+static uint8_t nibble_map[DIGIT_Z + 1][4];
+
+static void init_digit_map(void)
+{
+   for (int i = 0; i < 256; i++) {
+      switch (i) {
+      case '0'...'9': digit_map[i] = i - '0'; break;
+      case 'a'...'f': digit_map[i] = 10 + i - 'a'; break;
+      case 'A'...'F': digit_map[i] = 10 + i - 'A'; break;
+      case 'x': case 'X': digit_map[i] = DIGIT_X; break;
+      case 'z': case 'Z': case '?': digit_map[i] = DIGIT_Z; break;
+      case '_': digit_map[i] = DIGIT_SKIP; break;
+      default: digit_map[i] = DIGIT_INVALID; break;
+      }
+   }
+
+   // Unpacked bits for each hex digit with the most significant first
+   for (int i = 0; i < 16; i++) {
+      for (int j = 0; j < 4; j++)
+         nibble_map[i][j] = (i >> (3 - j)) & 1;
+   }
 
-   vpi_release_handle(arg);
+   memset(nibble_map[DIGIT_X], LOGIC_X, 4);
+   memset(nibble_map[DIGIT_Z], LOGIC_Z, 4);
 }
 
-static int calc_dec_size(int nr_bits, bool is_signed)
+static size_t mem_offset(const mem_task_t *mt, int64_t addr)
 {
-   // From Icarus Verilog vpi/sys_display.c
-   if (is_signed) --nr_bits;
-   int r = (nr_bits * 146L + 484) / 485;
-   if (is_signed) ++r;
-   return r;
+   const int64_t index = addr - mt->low;
+   if (mt->mem.left > mt->mem.right)
+      return (mt->high - mt->low - index) * mt->mem.width;
+   else
+      return index * mt->mem.width;
 }
 
-static void format_number(vpiHandle it, char radix, int fwidth)
+static bool get_mem_args(mem_task_t *mt, vpiHandle *callh)
 {
-   vpiHandle arg = vpi_scan(it);
-   if (arg == NULL)
-      return;
-
-   switch (radix) {
-   case 'd':
-   case 't':
-      {
-         s_vpi_value argval = { .format = vpiDecStrVal };
-         vpi_get_value(arg, &argval);
-
-         if (!vpi_chk_error(NULL)) {
-            const int nbits = vpi_get(vpiSize, arg);
-            const int dmax = calc_dec_size(nbits, false);
-
-            if (dmax > strlen(argval.value.str))
-               printf("%*s", dmax, argval.value.str);
-            else
-               fputs(argval.value.str, stdout);
-         }
+   *callh = vpi_handle(vpiSysTfCall, 0);
+   vpiHandle argv = vpi_iterate(vpiArgument, *callh);
+
+   vpiHandle file_arg = vpi_scan(argv);
+   vpiHandle mem_arg = vpi_scan(argv);
+   vpiHandle start_arg = vpi_scan(argv);
+   vpiHandle end_arg = start_arg ? vpi_scan(argv) : NULL;
+
+   s_vpi_value file = { .format = vpiStringVal };
+   vpi_get_value(file_arg, &file);
+   vpi_release_handle(file_arg);
+
+   // Later calls to vpi_get_value reuse the string buffer
+   mt->fname = xstrdup(file.value.str);
+
+   const bool valid = vpi_get_memory(mem_arg, &mt->mem);
+   vpi_release_handle(mem_arg);
+
+   mt->low  = MIN(mt->mem.left, mt->mem.right);
+   mt->high = MAX(mt->mem.left, mt->mem.right);
+
+   mt->start = mt->low;
+   mt->end = mt->high;
+   mt->has_end = false;
+
+   if (start_arg != NULL) {
+      s_vpi_value val = { .format = vpiIntVal };
+      vpi_get_value(start_arg, &val);
+      mt->start = val.value.integer;
+      vpi_release_handle(start_arg);
+
+      if (end_arg != NULL) {
+         vpi_get_value(end_arg, &val);
+         mt->end = val.value.integer;
+         mt->has_end = true;
+         vpi_release_handle(end_arg);
       }
-      break;
-   case 'x':
-   case 'h':
-      {
-         s_vpi_value argval = { .format = vpiHexStrVal };
-         vpi_get_value(arg, &argval);
-
-         if (!vpi_chk_error(NULL))
-            fputs(argval.value.str, stdout);
+   }
+
+   vpi_release_handle(argv);
+
+   if (!valid)
+      return false;
+
+   const int64_t addrs[] = { mt->start, mt->end };
+   for (int i = 0; i < ARRAY_LEN(addrs); i++) {
+      if (addrs[i] < mt->low || addrs[i] > mt->high) {
+         jit_msg(NULL, DIAG_ERROR, "address %"PRIi64" is outside the range "
+                 "of the memory", addrs[i]);
+         return false;
       }
-      break;
-   case 'b':
-      {
-         s_vpi_value argval = { .format = vpiBinStrVal };
-         vpi_get_value(arg, &argval);
-
-         if (!vpi_chk_error(NULL))
-            fputs(argval.value.str, stdout);
+   }
+
+   return true;
+}
+
+static const char *skip_space(const char *p, const char *limit)
+{
+   while (p < limit) {
+      if (isspace_iso88591(*p))
+         p++;
+      else if (*p == '/' && p + 1 < limit && p[1] == '/') {
+         while (p < limit && *p != '\n')
+            p++;
       }
-      break;
-   case 'f':
-      {
-         s_vpi_value argval = { .format = vpiRealVal };
-         vpi_get_value(arg, &argval);
-
-         if (!vpi_chk_error(NULL))
-            printf("%f", argval.value.real);
+      else if (*p == '/' && p + 1 < limit && p[1] == '*') {
+         for (p += 2; p < limit; p++) {
+            if (*p == '*' && p + 1 < limit && p[1] == '/') {
+               p += 2;
+               break;
+            }
+         }
       }
-      break;
+      else
+         break;
    }
 
-   vpi_release_handle(arg);
+   return p;
 }
 
-static void format_char(vpiHandle it, int fwidth)
+static void decode_word(const char *tok, size_t len, int radix, int width,
+                        uint8_t *word)
 {
-   vpiHandle arg = vpi_scan(it);
-   if (arg == NULL)
-      return;
+   // Digits are consumed from the least significant end of the token
+   // and expanded into unpacked bits a whole digit at a time
+   const int bits = radix == 16 ? 4 : 1;
+   int pos = width;
+   uint8_t first = 0;
+   for (const char *p = tok + len - 1; p >= tok && pos > 0; p--) {
+      const uint8_t digit = digit_map[(uint8_t)*p];
+      if (digit == DIGIT_SKIP)
+         continue;
 
-   s_vpi_value argval = { .format = vpiDecStrVal };
-   vpi_get_value(arg, &argval);
+      first = digit;
 
-   s_vpi_error_info ei;
-   vpi_chk_error(&ei);
-   const char ch = atoi(argval.value.str);
-   fputc(ch, stdout);
+      if (bits == 1)
+         word[--pos] = nibble_map[digit][3];
+      else if (pos >= 4)
+         memcpy(word + (pos -= 4), nibble_map[digit], 4);
+      else {
+         memcpy(word, nibble_map[digit] + 4 - pos, pos);
+         pos = 0;
+      }
+   }
 
-   vpi_release_handle(arg);
+   // Extend with X or Z if the leftmost digit is unknown
+   const uint8_t fill = first >= DIGIT_X ? nibble_map[first][0] : 0;
+   memset(word, fill, pos);
 }
 
-static void interpret_format(const char *fmt, vpiHandle it)
+static void read_memory(int radix)
 {
-   const char *start = fmt, *p = fmt;
+   INIT_ONCE(init_digit_map());
 
-   for (; *p; p++) {
-      if (*p == '%') {
-         if (start < p)
-            fwrite(start, 1, p - start, stdout);
+   vpiHandle callh;
+   mem_task_t mt;
+   if (!get_mem_args(&mt, &callh))
+      goto release_handles;
 
-         p++;   // Skip over '%'
+   FILE *f = fopen(mt.fname, "r");
+   if (f == NULL)
+      jit_msg(NULL, DIAG_FATAL, "failed to open %s: %s",
+              mt.fname, last_os_error());
 
-         int fwidth = 0;
-         if (isdigit_iso88591(*p))
-            fwidth = strtol(p + 1, (char **)&p, 10);
+   file_info_t info;
+   if (!get_handle_info(fileno(f), &info))
+      jit_msg(NULL, DIAG_FATAL, "%s: %s", mt.fname, last_os_error());
 
-         switch (*p) {
-         case 's':
-            format_string(it, fwidth);
-            break;
-         case 'd':
-         case 'b':
-         case 'x':
-         case 'h':
-         case 't':
-         case 'f':
-            format_number(it, *p, fwidth);
-            break;
-         case 'c':
-            format_char(it, fwidth);
-            break;
-         case '%':
-            fputc('%', stdout);
+   char *map = info.size > 0 ? map_file(fileno(f), info.size) : NULL;
+   fclose(f);
+
+   rt_signal_t *s = mt.mem.signal;
+   const size_t total = signal_width(s);
+
+   // Update a copy of the whole memory and deposit it in one go
+   uint8_t *values LOCAL = xmalloc(total);
+   memcpy(values, signal_value(s), total);
+
+   const int step = mt.start <= mt.end ? 1 : -1;
+   const int64_t first = MIN(mt.start, mt.end), last = MAX(mt.start, mt.end);
+
+   int64_t addr = mt.start, nwords = 0;
+   bool seen_addr = false;
+   const char *p = map, *limit = map + info.size;
+   while ((p = skip_space(p, limit)) < limit) {
+      const bool is_addr = (*p == '@');
+      if (is_addr)
+         p++;
+
+      const int base = is_addr ? 16 : radix;
+      const char *tok = p;
+      for (; p < limit; p++) {
+         const uint8_t digit = digit_map[(uint8_t)*p];
+         if (digit == DIGIT_INVALID || (digit < DIGIT_X && digit >= base))
             break;
-         default:
-            jit_msg(NULL, DIAG_WARN, "unknown format specifier '%c'", *p);
-         }
+      }
 
-         start = p + 1;
+      if (p == tok || (p < limit && !isspace_iso88591(*p) && *p != '/')) {
+         jit_msg(NULL, DIAG_ERROR, "%s: invalid character '%c' at offset "
+                 "%zu", mt.fname, p < limit ? *p : ' ', (size_t)(p - map));
+         break;
       }
-   }
 
-   if (start < p)
-      fwrite(start, 1, p - start, stdout);
-}
+      if (is_addr) {
+         addr = 0;
+         for (const char *q = tok; q < p; q++) {
+            if (digit_map[(uint8_t)*q] < 16)
+               addr = addr * 16 + digit_map[(uint8_t)*q];
+         }
 
-static void verilog_printf(void)
-{
-   vpiHandle call = vpi_handle(vpiSysTfCall, NULL);
-   assert(call != NULL);
+         if (addr < first || addr > last) {
+            jit_msg(NULL, DIAG_ERROR, "%s: address %"PRIx64" is outside "
+                    "the range of the memory", mt.fname, addr);
+            break;
+         }
+
+         seen_addr = true;
+         continue;
+      }
 
-   vpiHandle it = vpi_iterate(vpiArgument, call);
-   vpiHandle arg = vpi_scan(it);
+      if (addr < first || addr > last) {
+         jit_msg(NULL, DIAG_WARN, "%s: too many words in file for the "
+                 "address range", mt.fname);
+         break;
+      }
 
-   if (arg == NULL)
-      goto release_handles;
+      decode_word(tok, p - tok, radix, mt.mem.width,
+                  values + mem_offset(&mt, addr));
 
-   const bool has_format =
-      vpi_get(vpiType, arg) == vpiConstant
-      && vpi_get(vpiConstType, arg) == vpiStringConst;
+      addr += step;
+      nwords++;
+   }
 
-   if (has_format) {
-      s_vpi_value argval = { .format = vpiStringVal };
-      vpi_get_value(arg, &argval);
+   if (mt.has_end && !seen_addr && nwords < last - first + 1)
+      jit_msg(NULL, DIAG_WARN, "%s: not enough words in file for the "
+              "address range", mt.fname);
 
-      char *copy = xstrdup(argval.value.str);
-      interpret_format(copy, it);
-      free(copy);
+   if (map != NULL)
+      unmap_file(map, info.size);
 
-      vpi_release_handle(arg);
-      arg = vpi_scan(it);
-   }
+   deposit_signal(get_model(), s, values, 0, total);
 
-   while (arg != NULL) {
-      const bool is_null = vpi_get(vpiType, arg) == vpiOperation
-         && vpi_get(vpiOpType, arg) == vpiNullOp;
+ release_handles:
+   vpi_release_handle(callh);
+   free(mt.fname);
+}
 
-      if (is_null)
-         fputc(' ', stdout);
-      else {
-         s_vpi_value argval = { .format = vpiDecStrVal };
-         vpi_get_value(arg, &argval);
+static void write_memory(int radix)
+{
+   vpiHandle callh;
+   mem_task_t mt;
+   if (!get_mem_args(&mt, &callh))
+      goto release_handles;
 
-         const int nbits = vpi_get(vpiSize, arg);
-         const int dmax = calc_dec_size(nbits, false);
+   FILE *f = fopen(mt.fname, "w");
+   if (f == NULL)
+      jit_msg(NULL, DIAG_FATAL, "failed to open %s: %s",
+              mt.fname, last_os_error());
+
+   const uint8_t *values = signal_value(mt.mem.signal);
+   const int width = mt.mem.width, bits = radix == 16 ? 4 : 1;
+   const int step = mt.start <= mt.end ? 1 : -1;
+
+   char *line LOCAL = xmalloc(width + 2);
+
+   for (int64_t addr = mt.start; addr != mt.end + step; addr += step) {
+      const uint8_t *word = values + mem_offset(&mt, addr);
+
+      // Each digit is formed from up to four bits, the leftmost digit
+      // may be partial if the width is not a multiple of four
+      char *p = line;
+      for (int pos = 0, n = (width % bits) ?: bits; pos < width;
+           pos += n, n = bits) {
+         int value = 0, nx = 0, nz = 0;
+         for (int i = 0; i < n; i++) {
+            value = (value << 1) | (word[pos + i] & 1);
+            nx += (word[pos + i] == LOGIC_X);
+            nz += (word[pos + i] == LOGIC_Z);
+         }
 
-         if (dmax > strlen(argval.value.str))
-            printf("%*s", dmax, argval.value.str);
+         if (nz == n)
+            *p++ = 'z';
+         else if (nx + nz > 0)
+            *p++ = 'x';
          else
-            fputs(argval.value.str, stdout);
+            *p++ = "0123456789abcdef"[value];
       }
 
-      vpi_release_handle(arg);
-      arg = vpi_scan(it);
+      *p++ = '\n';
+      fwrite(line, p - line, 1, f);
    }
 
+   fclose(f);
+
  release_handles:
-   vpi_release_handle(call);
+   vpi_release_handle(callh);
+   free(mt.fname);
 }
 
-static PLI_INT32 display_tf(PLI_BYTE8 *userdata)
+static PLI_INT32 readmemh_tf(PLI_BYTE8 *userdata)
 {
-   verilog_printf();
-   printf("\n");
+   read_memory(16);
    return 0;
 }
 
-static PLI_INT32 write_tf(PLI_BYTE8 *userdata)
+static PLI_INT32 readmemb_tf(PLI_BYTE8 *userdata)
 {
-   verilog_printf();
+   read_memory(2);
    return 0;
 }
 
-static PLI_INT32 finish_tf(PLI_BYTE8 *userdata)
-{
-   notef("$finish called");
-   jit_abort();
-}
-
-static PLI_INT32 fatal_tf(PLI_BYTE8 *userdata)
-{
-   diag_t *d = diag_new(DIAG_FATAL, NULL);
-   diag_printf(d, "$fatal called");
-   diag_emit(d);
-
-   jit_abort_with_status(1);
-}
-
-static PLI_INT32 monitor_tf(PLI_BYTE8 *userdata)
+static PLI_INT32 writememh_tf(PLI_BYTE8 *userdata)
 {
-   // TODO
+   write_memory(16);
    return 0;
 }
 
-static PLI_INT32 readmemh_tf(PLI_BYTE8 *userdata)
+static PLI_INT32 writememb_tf(PLI_BYTE8 *userdata)
 {
-   vpiHandle callh = vpi_handle(vpiSysTfCall, 0);
-   vpiHandle argv = vpi_iterate(vpiArgument, callh);
-
-   vpiHandle file_arg = vpi_scan(argv);
-   vpiHandle mem_arg = vpi_scan(argv);
-
-   s_vpi_value file = { .format = vpiStringVal };
-   vpi_get_value(file_arg, &file);
-   vpi_release_handle(file_arg);
-
-   FILE *f = fopen(file.value.str, "r");
-   if (f == NULL)
-      jit_msg(NULL, DIAG_FATAL, "failed to open %s: %s",
-              file.value.str, last_os_error());
-
-   char *line LOCAL = NULL;
-   size_t line_len = 0, index = 0;
-   while (getline(&line, &line_len, f) != -1) {
-      char *savep = NULL;
-      char *tok = strtok_r(line, " \t\r\n", &savep);
-      if (tok == NULL)
-         continue;
-
-      vpiHandle elem = vpi_handle_by_index(mem_arg, index++);
-      if (elem == NULL)
-         break;
-
-      s_vpi_value val = { .format = vpiHexStrVal, .value.str = tok };
-      vpi_put_value(elem, &val, NULL, vpiNoDelay);
-
-      vpi_release_handle(elem);
-   }
-
-   fclose(f);
-
-   vpi_release_handle(mem_arg);
-   vpi_release_handle(argv);
-   vpi_release_handle(callh);
+   write_memory(2);
    return 0;
 }
 
@@ -375,33 +456,33 @@ static PLI_INT32 random_tf(PLI_BYTE8 *userdata)
 static s_vpi_systf_data builtins[] = {
    {
       .type   = vpiSysTask,
-      .tfname = "$display",
-      .calltf = display_tf
+      .tfname = "$finish",
+      .calltf = finish_tf
    },
    {
       .type   = vpiSysTask,
-      .tfname = "$write",
-      .calltf = write_tf
+      .tfname = "$fatal",
+      .calltf = fatal_tf
    },
    {
       .type   = vpiSysTask,
-      .tfname = "$finish",
-      .calltf = finish_tf
+      .tfname = "$readmemh",
+      .calltf = readmemh_tf
    },
    {
       .type   = vpiSysTask,
-      .tfname = "$fatal",
-      .calltf = fatal_tf
+      .tfname = "$readmemb",
+      .calltf = readmemb_tf
    },
    {
       .type   = vpiSysTask,
-      .tfname = "$monitor",
-      .calltf = monitor_tf
+      .tfname = "$writememh",
+      .calltf = writememh_tf
    },
    {
       .type   = vpiSysTask,
-      .tfname = "$readmemh",
-      .calltf = readmemh_tf
+      .tfname = "$writememb",
+      .calltf = writememb_tf
    },
    {
       .type        = vpiSysFunc,
@@ -113,49 +113,24 @@ void vpi_clear_error(void)
 void vpi_format_number(int size, const uint64_t *abits, const uint64_t *bbits,
                        s_vpi_value *val, text_buf_t *tb)
 {
-   const int nwords = (size + 63) / 64;
-   bool is_defined = true;
-   for (int i = 0; i < nwords; i++)
-      is_defined &= (bbits[i] == 0);
-
    switch (val->format) {
    case vpiBinStrVal:
-      for (int i = size - 1; i >= 0; i--) {
-         const vlog_logic_t bit =
-            ((bbits[i / 64] >> (i % 64)) & 1) << 1
-            | ((abits[i / 64] >> (i % 64)) & 1);
-         static const char map[] = "01zx";
-         tb_append(tb, map[bit]);
-      }
+      vec4_format('b', size, false, abits, bbits, tb);
       val->value.str = (PLI_BYTE8 *)tb_get(tb);
       break;
 
    case vpiDecStrVal:
-      if (is_defined)
-         vec2_itoa(size, abits, tb);
-      else
-         tb_cat(tb, "x");
+      vec4_itoa(size, true, abits, bbits, tb);
       val->value.str = (PLI_BYTE8 *)tb_get(tb);
       break;
 
    case vpiHexStrVal:
-      if (is_defined) {
-         for (int i = nwords - 1, field = ((size % 64) + 3) / 4;
-              i >= 0; i--, field = 16)
-            tb_printf(tb, "%0*"PRIx64, field, abits[i]);
-      }
-      else {
-         for (int i = 0; i < (size + 3) / 4; i++)
-            tb_append(tb, 'x');
-      }
+      vec4_format('h', size, false, abits, bbits, tb);
       val->value.str = (PLI_BYTE8 *)tb_get(tb);
       break;
 
    case vpiStringVal:
-      if (is_defined) {
-         for (int i = (size - 7) & ~7; i >= 0; i -= 8)
-            tb_append(tb, abits[i / 64] >> (i % 64));
-      }
+      vec4_format('s', size, false, abits, bbits, tb);
       val->value.str = (PLI_BYTE8 *)tb_get(tb);
       break;
 
@@ -2,6 +2,7 @@ package case1 is
     type t is (a, b, c);
     function test1(x : t) return integer;
     function test2(x : bit_vector(1 to 4)) return integer;
+    function test3(x : integer) return integer;
 end package;
 
 package body case1 is
@@ -39,4 +40,17 @@ package body case1 is
         return result;
     end function;
 
+    function test3(x : integer) return integer is
+    begin
+        case x is
+            when 1 => return 1;
+            when -50 => return 2;
+            when 1024 => return 3;
+            when 7 => return 4;
+            when 999999 => return 5;
+            when 65536 => return 6;
+            when others => return 0;
+        end case;
+    end function;
+
 end package body;
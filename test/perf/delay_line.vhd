@@ -0,0 +1,44 @@
+
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+
+entity delay_line is
+end entity;
+
+architecture tb of delay_line is
+
+    constant C_WIDTH   : natural := 32;
+    constant C_LATENCY : delay_length := 1 us;
+    constant C_PERIOD  : delay_length := 1 ns;
+    constant C_CYCLES  : natural := 1000000;
+
+    signal tx, rx : std_logic_vector(C_WIDTH - 1 downto 0);
+
+begin
+
+    -- Deep delay line: each driver keeps C_LATENCY / C_PERIOD
+    -- transactions queued
+    rx <= transport tx after C_LATENCY;
+
+    stim: process is
+    begin
+        for i in 0 to C_CYCLES - 1 loop
+            tx <= std_logic_vector(to_unsigned(i, C_WIDTH));
+            wait for C_PERIOD;
+        end loop;
+        wait;
+    end process;
+
+    check: process is
+    begin
+        wait for C_LATENCY;
+        for i in 0 to C_CYCLES - 1 loop
+            wait for C_PERIOD / 2;
+            assert unsigned(rx) = i;
+            wait for C_PERIOD / 2;
+        end loop;
+        wait;
+    end process;
+
+end architecture;
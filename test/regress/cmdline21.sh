@@ -0,0 +1,7 @@
+set -xe
+
+nvc -a $TESTDIR/regress/elab42.vhd -e --memory-budget=1 elab42
+
+test -f work/_WORK.ELAB42.elab.pack
+
+nvc -r elab42
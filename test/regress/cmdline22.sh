@@ -0,0 +1,11 @@
+set -xe
+
+nvc -a $TESTDIR/regress/elab42.vhd
+
+NVC_MAX_THREADS=1 nvc -e elab42
+cp work/_WORK.ELAB42.elab.pack single.pack
+
+NVC_MAX_THREADS=8 nvc -e elab42
+cmp single.pack work/_WORK.ELAB42.elab.pack
+
+nvc -r elab42
@@ -0,0 +1,97 @@
+set -xe
+
+nvc --work=otherlib -a - <<EOF
+package util is
+  function twice (x : integer) return integer;
+end package;
+
+package body util is
+  function twice (x : integer) return integer is
+  begin
+    return 2 * x;
+  end function;
+end package body;
+EOF
+
+nvc -L . --work=mylib -a - --jit-pack <<EOF
+library otherlib;
+use otherlib.util.all;
+
+package pack is
+  function add1 (x : integer) return integer;
+  function scale (x : integer) return integer;
+end package;
+
+package body pack is
+  function add1 (x : integer) return integer is
+  begin
+    return x + 1;
+  end function;
+
+  function scale (x : integer) return integer is
+  begin
+    return twice(x);
+  end function;
+end package body;
+EOF
+
+test -f mylib/_NVC_LIB.pack
+cp mylib/_NVC_LIB.pack saved.pack
+
+# Change the body of add1 and then put back the old pack: the design
+# only sees the original add1 if it is taken from the library pack
+nvc -L . --work=mylib -a - <<EOF
+library otherlib;
+use otherlib.util.all;
+
+package body pack is
+  function add1 (x : integer) return integer is
+  begin
+    return x + 2;
+  end function;
+
+  function scale (x : integer) return integer is
+  begin
+    return twice(x);
+  end function;
+end package body;
+EOF
+
+test ! -f mylib/_NVC_LIB.pack
+cp saved.pack mylib/_NVC_LIB.pack
+
+# The library pack must not contain a copy of twice from otherlib
+nvc --work=otherlib -a - <<EOF
+package body util is
+  function twice (x : integer) return integer is
+  begin
+    return 3 * x;
+  end function;
+end package body;
+EOF
+
+nvc -L . -a - -e cmdline23 -r <<EOF
+library mylib;
+use mylib.pack.all;
+
+entity cmdline23 is end entity;
+architecture test of cmdline23 is
+  signal s : integer := 5;
+begin
+  process is
+  begin
+    wait for 1 ns;
+    assert add1(s) = 6;
+    assert scale(s) = 15;
+    wait;
+  end process;
+end architecture;
+EOF
+
+# Analysing another unit into the library removes the stale pack
+nvc --work=mylib -a - <<EOF
+package other is
+end package;
+EOF
+
+test ! -f mylib/_NVC_LIB.pack
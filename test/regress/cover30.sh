@@ -0,0 +1,16 @@
+set -xe
+
+pwd
+which nvc
+
+nvc -a $TESTDIR/regress/cover30.vhd \
+    -e --cover=toggle+fsm-state+stop-at-threshold cover30 -r
+
+nvc --cover-export --format=xml cover30.ncdb > out.xml
+
+# Each bin stops counting once it reaches the threshold of one as its
+# watch is removed, otherwise the counts would keep increasing
+[ "$(grep -c '<toggle ' out.xml)" = 10 ]
+[ "$(grep -c '<toggle .* data="1"/>' out.xml)" = 10 ]
+[ "$(grep -c '<state ' out.xml)" = 3 ]
+[ "$(grep -c '<state .* data="1"/>' out.xml)" = 3 ]
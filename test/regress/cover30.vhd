@@ -0,0 +1,45 @@
+library ieee;
+use ieee.std_logic_1164.all;
+
+entity cover30 is
+end entity;
+
+architecture test of cover30 is
+
+    type t_state is (IDLE, BUSY, DONE);
+
+    signal clk   : std_logic := '0';
+    signal vec   : std_logic_vector(3 downto 0) := (others => '0');
+    signal state : t_state;
+    signal count : natural;
+
+begin
+
+    -- Toggle and state watches are removed once fully covered and must
+    -- not affect the rest of the simulation
+    process begin
+        for i in 1 to 50 loop
+            clk <= not clk;
+            vec <= not vec;
+            state <= t_state'val(i mod 3);
+            wait for 1 ns;
+        end loop;
+        wait;
+    end process;
+
+    process (clk) is
+    begin
+        if rising_edge(clk) then
+            count <= count + 1;
+        end if;
+    end process;
+
+    process begin
+        wait for 100 ns;
+        assert count = 25;
+        assert vec = "0000";
+        assert state = BUSY;
+        wait;
+    end process;
+
+end architecture;
@@ -0,0 +1,15 @@
+set -xe
+
+pwd
+which nvc
+
+nvc -a $TESTDIR/regress/cover31.vhd -e --cover=toggle cover31 -r
+nvc --cover-report -o html cover31.ncdb \
+    --exclude-file $TESTDIR/regress/data/cover31_ef.txt 2>&1 \
+    | grep -v '^** Debug:' | sed '/Code coverage report folder/,$d' \
+    | tee out.txt
+
+# Adjust output to be work directory relative
+sed -i -e "s/[^ ]*regress\/data\//data\//g" out.txt
+
+diff -u $TESTDIR/regress/gold/cover31.txt out.txt
@@ -0,0 +1,26 @@
+library ieee;
+use ieee.std_logic_1164.all;
+
+entity cover31_sub is
+end entity;
+
+architecture test of cover31_sub is
+    signal x, y : std_logic := '0';
+begin
+end architecture;
+
+-------------------------------------------------------------------------------
+
+library ieee;
+use ieee.std_logic_1164.all;
+
+entity cover31 is
+end entity;
+
+architecture test of cover31 is
+    signal a, b : std_logic := '0';
+begin
+
+    u: entity work.cover31_sub;
+
+end architecture;
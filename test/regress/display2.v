@@ -0,0 +1,25 @@
+module display2;
+  reg [7:0]         u;
+  reg signed [7:0]  s;
+  reg [99:0]        w;
+  reg [3:0]         x4;
+  real              r;
+  reg [8*5:1]       str;
+
+  initial begin
+    u = 200;
+    s = -5;
+    w = 100'hf_0000_0000_0000_0000_0000_0001;
+    x4 = 4'b1x0z;
+    r = 2.5;
+    str = "hello";
+    $display("u=%d s=%d", u, s);              // "u=200 s= -5"
+    $display("w=%h", w);                      // "w=f000000000000000000000001"
+    $display("x4=%b %h %d", x4, x4, x4);      // "x4=1x0z x  x"
+    $display("r=%f", r);                      // "r=2.500000"
+    $display("str=%s c=%c", str, 8'd65);      // "str=hello c=A"
+    $write("%d%%", 7'd42);
+    $write("\n");                             // " 42%"
+    $display("i=%d", 3 + 4);                  // "i=         7"
+  end
+endmodule // display2
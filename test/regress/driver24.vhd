@@ -0,0 +1,44 @@
+entity driver24 is
+end entity;
+
+library ieee;
+use ieee.std_logic_1164.all;
+
+architecture test of driver24 is
+    constant N : natural := 12;
+
+    signal bus : std_logic_vector(7 downto 0);
+begin
+
+    -- Many drivers on each element of a resolved signal
+    g: for i in 0 to N - 1 generate
+        process is
+        begin
+            bus <= (others => 'Z');
+            wait for (i + 1) * ns;
+            bus(i mod 8) <= '1';        -- Splits the nexus
+            wait for 1 ns;
+            bus(i mod 8) <= 'Z';
+            bus(7 - (i mod 8)) <= '0';
+            wait for 1 ns;
+            bus <= (others => 'Z');
+            wait;
+        end process;
+    end generate;
+
+    check: process is
+    begin
+        wait for 500 ps;
+        assert bus = "ZZZZZZZZ";
+        wait for 1 ns;
+        assert bus = "ZZZZZZZ1";
+        wait for 1 ns;
+        assert bus = "0ZZZZZ1Z" report to_string(bus);
+        wait for 1 ns;
+        assert bus = "Z0ZZZ1ZZ" report to_string(bus);
+        wait for 20 ns;
+        assert bus = "ZZZZZZZZ" report to_string(bus);
+        wait;
+    end process;
+
+end architecture;
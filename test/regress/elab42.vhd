@@ -0,0 +1,60 @@
+entity elab42_inc is
+    port ( x : in integer;
+           y : out integer );
+end entity;
+
+architecture test of elab42_inc is
+    signal tmp : integer;
+begin
+    tmp <= x + 1;
+    y <= tmp;
+end architecture;
+
+-------------------------------------------------------------------------------
+
+entity elab42_cell is
+    port ( x : in integer;
+           y : out integer );
+end entity;
+
+architecture test of elab42_cell is
+    signal mid : integer;
+begin
+    u: entity work.elab42_inc port map ( x, mid );
+    y <= mid * 2;
+end architecture;
+
+-------------------------------------------------------------------------------
+
+entity elab42 is
+end entity;
+
+architecture test of elab42 is
+    type int_vec is array (natural range <>) of integer;
+
+    component elab42_cell is
+        port ( x : in integer;
+               y : out integer );
+    end component;
+
+    signal xs, ys : int_vec(1 to 8);
+begin
+
+    -- Each instance after the first reuses the units lowered for g(1)
+    g: for i in xs'range generate
+        c: component elab42_cell port map ( xs(i), ys(i) );
+    end generate;
+
+    check: process is
+    begin
+        for i in xs'range loop
+            xs(i) <= i * 10;
+        end loop;
+        wait for 1 ns;
+        for i in ys'range loop
+            assert ys(i) = (i * 10 + 1) * 2 report integer'image(ys(i));
+        end loop;
+        wait;
+    end process;
+
+end architecture;
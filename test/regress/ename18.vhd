@@ -0,0 +1,50 @@
+entity sub is
+    generic ( N : natural );
+end entity;
+
+architecture test of sub is
+    signal s : natural := N;
+begin
+end architecture;
+
+-------------------------------------------------------------------------------
+
+entity ename18 is
+end entity;
+
+architecture test of ename18 is
+    constant N : natural := 40;
+    signal total : natural;
+begin
+
+    g: for i in 0 to N - 1 generate
+        u: entity work.sub generic map ( i * 2 );
+
+        b: block is
+            alias s is <<signal .ename18.g(i).u.s : natural>>;
+        begin
+            check: process is
+            begin
+                assert s = i * 2;
+                wait;
+            end process;
+        end block;
+    end generate;
+
+    p1: process is
+        variable sum : natural;
+    begin
+        wait for 0 ns;
+        for i in 0 to N - 1 loop
+            case i is
+                when 0 => sum := sum + <<signal .ename18.g(0).u.s : natural>>;
+                when 17 => sum := sum + <<signal .ename18.g(17).u.s : natural>>;
+                when 39 => sum := sum + <<signal .ename18.g(39).u.s : natural>>;
+                when others => null;
+            end case;
+        end loop;
+        assert sum = 0 + 34 + 78;
+        wait;
+    end process;
+
+end architecture;
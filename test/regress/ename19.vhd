@@ -0,0 +1,64 @@
+package pack is
+    type rec_t is record
+        a : natural;
+        b : boolean;
+    end record;
+end package;
+
+-------------------------------------------------------------------------------
+
+use work.pack.all;
+
+entity sub is
+end entity;
+
+architecture test of sub is
+    signal x : natural;
+    signal r : rec_t;
+begin
+
+    p1: process is
+    begin
+        wait for 1 ns;
+        x <= 1;
+        r <= (1, true);
+        wait for 1 ns;
+        x <= 2;
+        r <= (2, false);
+        wait;
+    end process;
+
+end architecture;
+
+-------------------------------------------------------------------------------
+
+use work.pack.all;
+
+entity ename19 is
+end entity;
+
+architecture test of ename19 is
+begin
+
+    uut: entity work.sub;
+
+    p2: process is
+        procedure check is
+            -- Bound after both signals have already changed value
+            alias ax is << signal .ename19.uut.x : natural >>;
+            alias ar is << signal .ename19.uut.r : rec_t >>;
+        begin
+            assert ax = 2;
+            assert ax'last_value = 1;
+            assert ar = (2, false);
+            assert ar'last_value = (1, true);
+            assert ar.a'last_value = 1;
+            assert ar.b'last_value;
+        end procedure;
+    begin
+        wait for 3 ns;
+        check;
+        wait;
+    end process;
+
+end architecture;
@@ -0,0 +1,31 @@
+set -xe
+
+# Analyse independent units into the same library concurrently
+for i in 1 2 3 4 5 6 7 8; do
+  nvc -a - <<EOF &
+package pack$i is
+  constant C : integer := $i;
+end package;
+EOF
+done
+wait
+
+nvc -a - <<EOF
+use work.pack1, work.pack2, work.pack3, work.pack4;
+use work.pack5, work.pack6, work.pack7, work.pack8;
+entity libdir6 is end entity;
+architecture test of libdir6 is
+begin
+  process is
+  begin
+    assert pack1.C + pack2.C + pack3.C + pack4.C = 10;
+    assert pack5.C + pack6.C + pack7.C + pack8.C = 26;
+    wait;
+  end process;
+end architecture;
+EOF
+
+nvc -e libdir6 -r
+
+# No temporary files should be left behind
+if ls work | grep '\.tmp$'; then exit 1; fi
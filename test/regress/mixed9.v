@@ -0,0 +1,5 @@
+module pass(i, o);
+  input [15:0] i;
+  output [15:0] o;
+  assign o = i;
+endmodule // pass
@@ -0,0 +1,33 @@
+entity mixed9 is
+end entity;
+
+library ieee;
+use ieee.std_logic_1164.all;
+
+architecture test of mixed9 is
+    component pass is
+        port ( i : in std_logic_vector(15 downto 0);
+               o : out std_logic_vector(15 downto 0) );
+    end component;
+
+    signal i, o : std_logic_vector(15 downto 0);
+begin
+
+    u: component pass
+        port map ( i, o );
+
+    check: process is
+    begin
+        i <= X"1234";
+        wait for 1 ns;
+        assert o = X"1234" report to_string(o);
+        i <= "01HL01HLXUW-0110";
+        wait for 1 ns;
+        assert o = "01100110UUUU0110" report to_string(o);
+        i(7 downto 0) <= X"a5";
+        wait for 1 ns;
+        assert o = "01100110" & X"a5" report to_string(o);
+        wait;
+    end process;
+
+end architecture;
@@ -0,0 +1,15 @@
+module monitor1;
+  reg [3:0] a = 0;
+  reg       b = 0;
+
+  initial begin
+    $monitor("a=%d b=%b", a, b);
+    #1 a = 1;
+    #1 begin
+      a = 2;
+      b = 1;           // Printed once with the change to a
+    end
+    #1 a = 2;          // Not printed as nothing changed
+    #1 a = 3;
+  end
+endmodule // monitor1
@@ -0,0 +1,10 @@
+module monitor2;
+  reg [3:0] a = 1;
+  reg [3:0] b = 2;
+
+  initial begin
+    $monitor("a=%d sum=%d", a, a + b);
+    #1 a = 3;
+    #1 b = 4;                           // Only read by the expression
+  end
+endmodule // monitor2
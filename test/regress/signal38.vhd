@@ -0,0 +1,58 @@
+entity sub38 is
+    port ( p : in integer );
+end entity;
+
+architecture test of sub38 is
+begin
+
+    check: process is
+    begin
+        wait on p;
+        assert p = 2;
+        assert p'last_value = 1;
+        wait;
+    end process;
+
+end architecture;
+
+-------------------------------------------------------------------------------
+
+entity signal38 is
+end entity;
+
+architecture test of signal38 is
+    type t_mem is array (natural range <>) of bit_vector(31 downto 0);
+
+    procedure check_last (signal x : in integer; value : in integer) is
+    begin
+        assert x'last_value = value;
+    end procedure;
+
+    signal a, b, c, d : integer := 1;
+    signal mem : t_mem(0 to 4095);      -- Never reads 'LAST_VALUE
+begin
+
+    u: entity work.sub38 port map ( c );
+
+    stim: process is
+        alias e is << signal .signal38.d : integer >>;
+    begin
+        assert e'last_value = 1;        -- Starts tracking before any event
+        a <= 2;
+        b <= 3;
+        c <= 2;
+        d <= 4;
+        mem(5) <= X"12345678";
+        wait for 1 ns;
+        assert a'last_value = 1;
+        check_last(b, 1);
+        assert e'last_value = 1;
+        assert d = 4;
+        assert mem(5) = X"12345678";
+        a <= 5;
+        wait for 1 ns;
+        assert a'last_value = 2;
+        wait;
+    end process;
+
+end architecture;
@@ -0,0 +1,51 @@
+entity signal39 is
+end entity;
+
+architecture test of signal39 is
+    signal v : bit_vector(0 to 63);
+    signal w : bit_vector(0 to 63);
+    signal count1, count2, count3 : natural;
+begin
+
+    g: for i in v'range generate
+        -- Each element has its own driver so the signal is split into
+        -- many nexuses
+        v(i) <= '1' after (i mod 4) * 1 ns + 1 ns,
+                '0' after 10 ns;
+    end generate;
+
+    w(0 to 31) <= v(0 to 31);
+    w(32 to 63) <= not v(32 to 63);
+
+    p1: process (v) is
+    begin
+        count1 <= count1 + 1;
+    end process;
+
+    p2: process is
+    begin
+        wait on v;
+        count2 <= count2 + 1;
+        wait on v(5);
+        count2 <= count2 + 1;
+        wait on v, w;
+        count2 <= count2 + 1;
+    end process;
+
+    p3: process is
+    begin
+        wait until w = (0 to 31 => '1', 32 to 63 => '0') for 20 ns;
+        count3 <= count3 + 1;
+        wait;
+    end process;
+
+    check: process is
+    begin
+        wait for 15 ns;
+        assert count1 = 6 report integer'image(count1);  -- 0, 1, 2, 3, 4, 10 ns
+        assert count2 = 5 report integer'image(count2);
+        assert count3 = 1;
+        wait;
+    end process;
+
+end architecture;
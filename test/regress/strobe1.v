@@ -0,0 +1,14 @@
+module strobe1;
+  reg [3:0] a = 0;
+  reg [3:0] b = 0;
+
+  initial begin
+    a = 1;
+    $strobe("strobe a=%d", a);    // Printed after the update to a below
+    $display("display a=%d", a);
+    a <= 2;
+    #1 b <= 5;
+    $strobe("b=%d sum=%d", b, a + b);
+    $display("b=%d", b);
+  end
+endmodule // strobe1
@@ -0,0 +1,35 @@
+module vlog31;
+  reg [11:0] a [0:7];
+  reg [11:0] b [7:0];
+  reg [5:0]  c [0:3];
+  integer    i;
+  reg        failed = 0;
+
+  initial begin
+    for (i = 0; i < 8; i = i + 1)
+      a[i] = i * 12'h111;
+    a[5] = 12'bxxxx_0000_zzzz;
+
+    $writememh("vlog31.hex", a);
+    $readmemh("vlog31.hex", b);
+
+    for (i = 0; i < 8; i = i + 1) begin
+      if (b[i] !== a[i]) begin
+        $display("FAILED -- b[%d] = %h", i, b[i]);
+        failed = 1;
+      end
+    end
+
+    $writememb("vlog31.bin", a, 2, 3);
+    $readmemb("vlog31.bin", c, 1, 2);
+
+    if (c[0] !== 6'bx || c[1] !== 6'h22 || c[2] !== 6'h33) begin
+      $display("FAILED -- c = %h %h %h", c[0], c[1], c[2]);
+      failed = 1;
+    end
+
+    if (!failed)
+      $display("PASSED");
+  end
+
+endmodule // vlog31
@@ -0,0 +1,44 @@
+module vlog32;
+  reg  [7:0] a, b;
+  wire [7:0] sum, inv, both;
+  reg  [3:0] count [0:7];
+  reg        failed = 0;
+
+  genvar i;
+
+  for (i = 0; i < 8; i = i + 1) begin : g
+    assign sum[i] = a[i] ^ b[i];
+    not u(inv[i], a[i]);
+    and v(both[i], a[i], b[i]);
+
+    initial count[i] = i;
+
+    always @(posedge a[i])
+      count[i] <= count[i] + i;
+  end
+
+  initial begin
+    a = 8'h00;
+    b = 8'hf0;
+    #1;
+    if (sum !== 8'hf0 || inv !== 8'hff || both !== 8'h00) begin
+      $display("FAILED -- sum=%h inv=%h both=%h", sum, inv, both);
+      failed = 1;
+    end
+    a = 8'h3c;
+    #1;
+    if (sum !== 8'hcc || inv !== 8'hc3 || both !== 8'h30) begin
+      $display("FAILED -- sum=%h inv=%h both=%h", sum, inv, both);
+      failed = 1;
+    end
+    if (count[0] !== 0 || count[1] !== 1 || count[2] !== 4
+        || count[5] !== 10 || count[7] !== 7) begin
+      $display("FAILED -- count = %d %d %d %d %d", count[0], count[1],
+               count[2], count[5], count[7]);
+      failed = 1;
+    end
+    if (!failed)
+      $display("PASSED");
+  end
+
+endmodule // vlog32
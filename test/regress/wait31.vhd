@@ -0,0 +1,43 @@
+entity wait31 is
+end entity;
+
+architecture test of wait31 is
+    constant N : integer := 500;
+    signal clk  : bit := '0';
+    signal done : bit_vector(1 to N);
+    signal count : integer_vector(1 to N) := (others => 0);
+begin
+
+    clkgen: clk <= not clk after 5 ns when done /= (1 to N => '1');
+
+    g: for i in 1 to N generate
+        -- Processes alternately subscribe and unsubscribe from the
+        -- clock's sensitivity list
+        p: process is
+            variable c : integer := 0;
+        begin
+            for j in 1 to 10 loop
+                wait on clk;
+                if clk = '1' then
+                    c := c + 1;
+                end if;
+                if i mod 3 = 0 then
+                    wait for 1 ns;      -- Not sensitive to clk here
+                end if;
+            end loop;
+            count(i) <= c;
+            done(i) <= '1';
+            wait;
+        end process;
+    end generate;
+
+    check: process is
+    begin
+        wait until done = (1 to N => '1');
+        for i in 1 to N loop
+            assert count(i) = 5 report integer'image(i);
+        end loop;
+        wait;
+    end process;
+
+end architecture;
@@ -0,0 +1,63 @@
+library ieee;
+use ieee.std_logic_1164.all;
+
+entity wait32 is
+end entity;
+
+architecture test of wait32 is
+    signal clk   : std_logic := '0';
+    signal valid : std_logic := '0';
+    signal data  : integer := 0;
+    signal x, y  : integer := 0;
+    signal stop  : boolean := false;
+begin
+
+    clk <= not clk after 5 ns when not stop;
+
+    stim: process is
+    begin
+        for i in 1 to 20 loop
+            wait until falling_edge(clk);
+            valid <= '1' when i mod 4 = 0 else '0';
+            data <= i;
+        end loop;
+        x <= 3;
+        wait for 1 ns;
+        y <= 7;
+        wait for 20 ns;
+        stop <= true;
+        wait;
+    end process;
+
+    check1: process is
+        variable count : natural := 0;
+    begin
+        loop
+            wait until rising_edge(clk) and valid = '1';
+            assert data mod 4 = 0;
+            assert valid = '1';
+            count := count + 1;
+            exit when count = 5;
+        end loop;
+        assert now = 205 ns report to_string(now);
+        wait;
+    end process;
+
+    check2: process is
+    begin
+        wait until x = 3 or y = 7;
+        assert x = 3;
+        assert y = 0;
+        wait until y = 7;
+        assert x = 3;
+        wait;
+    end process;
+
+    check3: process is
+    begin
+        wait until clk'event and clk = '1' and valid = '1';
+        assert now = 45 ns report to_string(now);
+        wait;
+    end process;
+
+end architecture;
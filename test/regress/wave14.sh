@@ -0,0 +1,10 @@
+set -xe
+
+pwd
+which nvc
+which fstdump
+
+nvc -a $TESTDIR/regress/wave14.vhd -e wave14 -r -w --include ':wave14:u:x'
+
+fstdump wave14.fst > wave14.dump
+diff -u $TESTDIR/regress/gold/wave14.dump wave14.dump
@@ -0,0 +1,36 @@
+entity wave14_sub is
+    port ( i : in bit );
+end entity;
+
+architecture test of wave14_sub is
+    signal x, y : bit;
+begin
+    x <= i;
+    y <= not i;
+end architecture;
+
+-------------------------------------------------------------------------------
+
+entity wave14 is
+end entity;
+
+architecture test of wave14 is
+    component wave14_sub is
+        port ( i : in bit );
+    end component;
+
+    signal s : bit;
+begin
+
+    u: component wave14_sub
+        port map ( s );
+
+    main: process is
+    begin
+        s <= '1';
+        wait for 1 ns;
+        s <= '0';
+        wait;
+    end process;
+
+end architecture;
@@ -40,7 +40,7 @@ static cover_data_t *run_cover(tree_t top)
 
    rt_model_t *m = model_new(j, db);
 
-   elab(tree_to_object(top), j, ur, mc, db, NULL, m);
+   elab(tree_to_object(top), j, ur, mc, db, NULL, m, NULL);
 
    model_reset(m);
    model_run(m, UINT64_MAX);
@@ -1634,7 +1634,7 @@ START_TEST(test_issue759)
    jit_t *jit = jit_new(ur, mc);
 
    rt_model_t *m = model_new(jit, cover);
-   tree_t e = elab(tree_to_object(a), jit, ur, mc, cover, NULL, m);
+   tree_t e = elab(tree_to_object(a), jit, ur, mc, cover, NULL, m, NULL);
    fail_if(e == NULL);
 
    model_free(m);
@@ -1770,7 +1770,7 @@ START_TEST(test_vlog1)
    jit_t *j = jit_new(ur, mc);
    rt_model_t *m = model_new(j, NULL);
 
-   tree_t top = elab(obj, j, ur, mc, NULL, NULL, m);
+   tree_t top = elab(obj, j, ur, mc, NULL, NULL, m, NULL);
    fail_unless(top == NULL);
 
    model_free(m);
@@ -1960,7 +1960,7 @@ START_TEST(test_issue1012)
    cover_data_t *cover = cover_data_init(COVER_MASK_TOGGLE, 0, 0);
    rt_model_t *m = model_new(jit, NULL);
 
-   tree_t e = elab(tree_to_object(a), jit, ur, mc, cover, NULL, m);
+   tree_t e = elab(tree_to_object(a), jit, ur, mc, cover, NULL, m, NULL);
    fail_if(e == NULL);
 
    model_free(m);
@@ -776,6 +776,15 @@ START_TEST(test_case1)
    ck_assert_int_eq(jit_call(j, test2, NULL, eff).integer, 15);
    ck_assert_int_eq(jit_call(j, test2, NULL, ten).integer, 10);
 
+   jit_handle_t test3 = compile_for_test(j, "WORK.CASE1.TEST3(I)I");
+   ck_assert_int_eq(jit_call(j, test3, NULL, 1).integer, 1);
+   ck_assert_int_eq(jit_call(j, test3, NULL, -50).integer, 2);
+   ck_assert_int_eq(jit_call(j, test3, NULL, 1024).integer, 3);
+   ck_assert_int_eq(jit_call(j, test3, NULL, 7).integer, 4);
+   ck_assert_int_eq(jit_call(j, test3, NULL, 999999).integer, 5);
+   ck_assert_int_eq(jit_call(j, test3, NULL, 8).integer, 0);
+   ck_assert_int_eq(jit_call(j, test3, NULL, 0).integer, 0);
+
    jit_free(j);
    fail_if_errors();
 }
@@ -1440,6 +1449,92 @@ START_TEST(test_cfg2)
 }
 END_TEST
 
+START_TEST(test_switch1)
+{
+   jit_t *j = jit_new(NULL, NULL);
+
+   const char *text1 =
+      "    RECV    R0, #0       \n"
+      "    $SWITCH R0, #4       \n"
+      "    $CASE   R0, #-1, L1  \n"
+      "    $CASE   R0, #0, L2   \n"
+      "    $CASE   R0, #1, L3   \n"
+      "    $CASE   R0, #2, L4   \n"
+      "    JUMP    L5           \n"
+      "L1: SEND    #0, #10      \n"
+      "    RET                  \n"
+      "L2: SEND    #0, #20      \n"
+      "    RET                  \n"
+      "L3: SEND    #0, #30      \n"
+      "    RET                  \n"
+      "L4: SEND    #0, #40      \n"
+      "    RET                  \n"
+      "L5: SEND    #0, #50      \n"
+      "    RET                  \n";
+
+   jit_handle_t h1 = jit_assemble(j, ident_new("myfunc1"), text1);
+
+   const struct {
+      int64_t arg;
+      int64_t result;
+   } cases1[] = {
+      { -2, 50 }, { -1, 10 }, { 0, 20 }, { 1, 30 }, { 2, 40 }, { 3, 50 },
+      { INT64_MIN, 50 }, { INT64_MAX, 50 },
+   };
+
+   tlab_t tlab = jit_null_tlab(j);
+
+   for (int i = 0; i < ARRAY_LEN(cases1); i++) {
+      jit_scalar_t result, p0 = { .integer = cases1[i].arg };
+      fail_unless(jit_fastcall(j, h1, &result, p0, p0, &tlab));
+      ck_assert_int_eq(result.integer, cases1[i].result);
+   }
+
+   jit_func_t *f1 = jit_get_func(j, h1);
+   jit_cfg_t *cfg1 = jit_get_cfg(f1);
+
+   ck_assert_int_eq(cfg1->nblocks, 7);
+   ck_assert_int_eq(cfg1->blocks[0].out.count, 5);
+
+   jit_free_cfg(cfg1);
+
+   const char *text2 =
+      "    RECV    R0, #0       \n"
+      "    $SWITCH R0, #6       \n"
+      "    $CASE   R0, #-100, L1\n"
+      "    $CASE   R0, #3, L2   \n"
+      "    $CASE   R0, #7, L1   \n"
+      "    $CASE   R0, #64, L2  \n"
+      "    $CASE   R0, #1000, L1\n"
+      "    $CASE   R0, #5000, L2\n"
+      "    JUMP    L3           \n"
+      "L1: SEND    #0, #1       \n"
+      "    RET                  \n"
+      "L2: SEND    #0, #2       \n"
+      "    RET                  \n"
+      "L3: SEND    #0, #3       \n"
+      "    RET                  \n";
+
+   jit_handle_t h2 = jit_assemble(j, ident_new("myfunc2"), text2);
+
+   const struct {
+      int64_t arg;
+      int64_t result;
+   } cases2[] = {
+      { -100, 1 }, { -99, 3 }, { 3, 2 }, { 4, 3 }, { 7, 1 }, { 64, 2 },
+      { 1000, 1 }, { 5000, 2 }, { 5001, 3 }, { 0, 3 },
+   };
+
+   for (int i = 0; i < ARRAY_LEN(cases2); i++) {
+      jit_scalar_t result, p0 = { .integer = cases2[i].arg };
+      fail_unless(jit_fastcall(j, h2, &result, p0, p0, &tlab));
+      ck_assert_int_eq(result.integer, cases2[i].result);
+   }
+
+   jit_free(j);
+}
+END_TEST
+
 START_TEST(test_lvn4)
 {
    jit_t *j = jit_new(NULL, NULL);
@@ -2196,6 +2291,7 @@ Suite *get_jit_tests(void)
    tcase_add_test(tc, test_trim1);
    tcase_add_test(tc, test_lvn11);
    tcase_add_test(tc, test_lvn12);
+   tcase_add_test(tc, test_switch1);
    suite_add_tcase(s, tc);
 
    return s;
@@ -1991,7 +1991,7 @@ START_TEST(test_cover)
                                         | COVER_MASK_BRANCH, 0, 0);
    rt_model_t *m = model_new(jit, data);
 
-   elab(tree_to_object(a), jit, ur, mc, data, NULL, m);
+   elab(tree_to_object(a), jit, ur, mc, data, NULL, m, NULL);
 
    vcode_unit_t v0 = find_unit("WORK.COVER_ENT.P1");
    vcode_select_unit(v0);
@@ -2567,7 +2567,7 @@ START_TEST(test_choice1)
    jit_t *jit = jit_new(ur, mc);
    cover_data_t *data = cover_data_init(COVER_MASK_BRANCH, 0, 0);
    rt_model_t *m = model_new(jit, NULL);
-   elab(tree_to_object(a), jit, ur, mc, data, NULL, m);
+   elab(tree_to_object(a), jit, ur, mc, data, NULL, m, NULL);
 
    vcode_unit_t v0 = find_unit("WORK.CHOICE1.P1");
    vcode_select_unit(v0);
@@ -5082,7 +5082,7 @@ START_TEST(test_issue582)
    cover_data_t *data = cover_data_init(COVER_MASK_ALL, 0, 0);
    rt_model_t *m = model_new(jit, NULL);
 
-   elab(tree_to_object(a), jit, ur, mc, data, NULL, m);
+   elab(tree_to_object(a), jit, ur, mc, data, NULL, m, NULL);
 
    model_free(m);
    jit_free(jit);
@@ -6612,7 +6612,7 @@ START_TEST(test_issue1194)
    cover_data_t *data = cover_data_init(COVER_MASK_EXPRESSION, 0, 0);
    rt_model_t *m = model_new(jit, NULL);
 
-   elab(tree_to_object(a), jit, get_registry(), get_mir(), data, NULL, m);
+   elab(tree_to_object(a), jit, get_registry(), get_mir(), data, NULL, m, NULL);
 
    mir_unit_t *mu = find_unit2("WORK.ISSUE1194.B.P_actual");
 
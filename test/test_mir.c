@@ -1153,6 +1153,74 @@ START_TEST(test_cfg1)
 }
 END_TEST
 
+START_TEST(test_cover1)
+{
+   mir_context_t *mc = mir_context_new();
+
+   ident_t pname = ident_new("cover1.parent");
+   mir_unit_t *parent = mir_unit_new(mc, pname, NULL, MIR_UNIT_INSTANCE, NULL);
+
+   mir_type_t t_int32 = mir_int_type(parent, INT32_MIN, INT32_MAX);
+   mir_type_t t_ptr = mir_pointer_type(parent, t_int32);
+   mir_add_var(parent, t_ptr, MIR_NULL_STAMP, ident_new("#counters"), 0);
+   mir_build_return(parent, MIR_NULL_VALUE);
+   mir_put_unit(mc, parent);
+
+   mir_unit_t *mu = mir_unit_new(mc, ident_new("cover1"), NULL,
+                                 MIR_UNIT_PROCESS, mir_get_shape(mc, pname));
+
+   mir_block_t b1 = mir_add_block(mu);
+   mir_build_return(mu, MIR_NULL_VALUE);
+
+   mir_set_cursor(mu, b1, MIR_APPEND);
+
+   mir_value_t counters = mir_build_load(mu, mir_build_var_upref(mu, 1, 0));
+   mir_build_cover_stmt(mu, counters, 0);
+   mir_build_cover_stmt(mu, counters, 1);
+   mir_build_cover_branch(mu, counters, 2);
+   mir_build_fcall(mu, ident_new("func"), MIR_NULL_TYPE, MIR_NULL_STAMP,
+                   NULL, 0);
+   mir_build_cover_stmt(mu, counters, 3);
+   mir_build_cover_stmt(mu, counters, 4);
+   mir_build_wait(mu, b1);
+
+   mir_optimise(mu, MIR_PASS_COV);
+
+   static const mir_match_t bb0[] = {
+      { MIR_OP_VAR_UPREF, ENUM(1), {}, ENUM(0) },
+      { MIR_OP_LOAD },
+      { MIR_OP_ARRAY_REF, {}, CONST(1) },
+      { MIR_OP_STORE },
+      { MIR_OP_ARRAY_REF, {}, CONST(2) },
+      { MIR_OP_STORE },
+      { MIR_OP_ARRAY_REF, {}, CONST(4) },
+      { MIR_OP_STORE },
+      { MIR_OP_RETURN },
+   };
+   mir_match(mu, 0, bb0);
+
+   static const int32_t refs[] = { 0, 0, 3 };
+   for (int i = 0; i < ARRAY_LEN(refs); i++) {
+      mir_value_t store = mir_get_node(mu, mir_get_block(mu, 0), 3 + i * 2);
+      mir_assert_const_eq(mu, mir_get_arg(mu, store, 1),
+                          INT32_MIN | refs[i]);
+   }
+
+   static const mir_match_t bb1[] = {
+      { MIR_OP_VAR_UPREF, ENUM(1), {}, ENUM(0) },
+      { MIR_OP_LOAD },
+      { MIR_OP_COVER_STMT, {}, ENUM(0) },
+      { MIR_OP_FCALL, LINK("func") },
+      { MIR_OP_COVER_STMT, {}, ENUM(3) },
+      { MIR_OP_WAIT, BLOCK(1) },
+   };
+   mir_match(mu, 1, bb1);
+
+   mir_unit_free(mu);
+   mir_context_free(mc);
+}
+END_TEST
+
 Suite *get_mir_tests(void)
 {
    Suite *s = suite_create("mir");
@@ -1181,6 +1249,7 @@ Suite *get_mir_tests(void)
    tcase_add_test(tc, test_vec2);
    tcase_add_test(tc, test_check1);
    tcase_add_test(tc, test_cfg1);
+   tcase_add_test(tc, test_cover1);
    suite_add_tcase(s, tc);
 
    return s;
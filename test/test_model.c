@@ -447,7 +447,7 @@ START_TEST(test_process1)
    jit_t *j = jit_new(ur, mc);
    rt_model_t *m = model_new(j, NULL);
 
-   tree_t top = elab(tree_to_object(a), j, ur, mc, NULL, NULL, m);
+   tree_t top = elab(tree_to_object(a), j, ur, mc, NULL, NULL, m, NULL);
    ck_assert_ptr_nonnull(top);
 
    model_reset(m);
@@ -56,7 +56,7 @@ START_TEST(test_examine1)
 
    rt_model_t *m = model_new(j, NULL);
 
-   tree_t top = elab(tree_to_object(arch), j, ur, mc, NULL, NULL, m);
+   tree_t top = elab(tree_to_object(arch), j, ur, mc, NULL, NULL, m, NULL);
    fail_if(top == NULL);
 
    tcl_shell_t *sh = shell_new(j);
@@ -215,7 +215,7 @@ START_TEST(test_wave1)
    rt_model_t *m = model_new(j, NULL);
 
    tree_t top = elab(tree_to_object(tree_primary(arch)), j, ur, mc,
-                     NULL, NULL, m);
+                     NULL, NULL, m, NULL);
    fail_if(top == NULL);
 
    shell_reset(sh, top);
@@ -371,7 +371,7 @@ START_TEST(test_force1)
 
    rt_model_t *m = model_new(j, NULL);
 
-   tree_t top = elab(tree_to_object(arch), j, ur, mc, NULL, NULL, m);
+   tree_t top = elab(tree_to_object(arch), j, ur, mc, NULL, NULL, m, NULL);
    fail_if(top == NULL);
 
    tcl_shell_t *sh = shell_new(j);
@@ -477,7 +477,7 @@ START_TEST(test_describe1)
 
    rt_model_t *m = model_new(j, NULL);
 
-   tree_t top = elab(tree_to_object(arch), j, ur, mc, NULL, NULL, m);
+   tree_t top = elab(tree_to_object(arch), j, ur, mc, NULL, NULL, m, NULL);
    fail_if(top == NULL);
 
    tcl_shell_t *sh = shell_new(j);
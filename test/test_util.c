@@ -217,7 +217,7 @@ tree_t run_elab(void)
 
    rt_model_t *m = model_new(j, NULL);
 
-   tree_t e = elab(top, j, ur, mc, NULL, NULL, m);
+   tree_t e = elab(top, j, ur, mc, NULL, NULL, m, NULL);
 
    model_free(m);
 